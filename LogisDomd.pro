@@ -0,0 +1,7 @@
+# Headless build : same core, main window never shown, offscreen platform,
+# the GUI build connects to it in remote mode
+
+TARGET = logisdomd
+DEFINES += _TTY_POSIX_ POSIX LOGISDOM_HEADLESS
+
+include (logisdom_app.pri)
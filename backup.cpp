@@ -25,6 +25,7 @@
 #include "logisdom.h"
 #ifdef Q_OS_LINUX
     #include <utime.h>
+    #include <unistd.h>
     #include <sys/stat.h>
 #endif
 
@@ -53,6 +54,8 @@ void backup::run()
     if (!QDir().exists(backupFolder))
         if (!QDir().mkdir(backupFolder)) return;
     QFile::remove(backupFolder + logFileName);
+    logText.clear();
+    readManifest();
     if (!datFolder.isEmpty()) saveFolder(datFolder, backupFolder + backupDatFolder, "dat");
     if (!zipFolder.isEmpty())
     {
@@ -61,6 +64,16 @@ void backup::run()
     }
     if (!iconFolder.isEmpty()) saveFolder(iconFolder, backupFolder + backupIconFolder, "png");
     saveFile(configFileName, backupFolder + configFileName);
+    writeManifest();
+    if (!abort) makeSnapshot();
+    QFile logFile(backupFolder + logFileName);
+    if (logFile.open(QIODevice::Append | QIODevice::Text))
+    {
+        QTextStream out(&logFile);
+        out << logText;
+        logFile.close();
+    }
+    logText.clear();
     datFolder.clear();
     zipFolder.clear();
     iconFolder.clear();
@@ -68,42 +81,61 @@ void backup::run()
 
 
 
+
+// Unchanged files are skipped from the manifest, grown files get only their new tail
 void backup::saveFile(QString sourceFileName, QString destinationFileName)
 {
     if (abort) return;
-    QFile sourceFile(sourceFileName);
-    QFileInfo sourceInfo(sourceFile);
-    QFile destinationFile(destinationFileName);
-    if (destinationFile.exists())
+    QFileInfo sourceInfo(sourceFileName);
+    QFileInfo destinationInfo(destinationFileName);
+    QString key = destinationFileName.mid(backupFolder.length());
+    qint64 size = sourceInfo.size();
+    qint64 modified = sourceInfo.lastModified().toSecsSinceEpoch();
+    if (destinationInfo.exists())
     {
-        QFileInfo destinationInfo(destinationFile);
-        if (sourceInfo.fileTime(QFileDevice::FileModificationTime).secsTo(destinationInfo.fileTime(QFileDevice::FileModificationTime)) < 0)
+        qint64 destinationModified = destinationInfo.lastModified().toSecsSinceEpoch();
+        if (!manifest.contains(key) && (destinationInfo.size() == size) && (destinationModified == modified))
         {
-            QFile::remove(destinationFileName);
-            if (sourceFile.copy(destinationFileName))
-            {
-                makeDateIdentical(sourceFileName, destinationFileName);
-                log(sourceFileName + " overwrite " + destinationFileName);
-            }
-            else log(sourceFileName + " not possible to copy to " + destinationFileName);
+            manifestEntry entry;
+            entry.size = size;
+            entry.modified = modified;
+            entry.tail = tailChecksum(destinationFileName, size);
+            manifest.insert(key, entry);
+        }
+        manifestEntry known = manifest.value(key);
+        if ((known.size == size) && (known.modified == modified) && (destinationInfo.size() == size))
+        {
+            log(sourceFileName + " skipped " + destinationFileName + " no change");
+            return;
+        }
+        if (!manifest.contains(key) && (destinationModified > modified))
+        {
+            log(sourceFileName + " skipped " + destinationFileName + " is newer");
+            return;
         }
-        else
+        if ((known.size > 0) && (size > known.size) && (destinationInfo.size() == known.size) && (tailChecksum(sourceFileName, known.size) == known.tail))
         {
-            if (sourceInfo.fileTime(QFileDevice::FileModificationTime).secsTo(destinationInfo.fileTime(QFileDevice::FileModificationTime)) == 0)
-                log(sourceFileName + " skipped " + destinationFileName + " no change");
-            else
-                log(sourceFileName + " skipped " + destinationFileName + " is newer");
+            if (appendTail(sourceFileName, destinationFileName, known.size))
+            {
+                log(sourceFileName + QString(" %1 bytes appended to ").arg(size - known.size) + destinationFileName);
+            }
+            else log(sourceFileName + " not possible to append to " + destinationFileName);
         }
+        else if (copyFile(sourceFileName, destinationFileName)) log(sourceFileName + " overwrite " + destinationFileName);
+        else log(sourceFileName + " not possible to copy to " + destinationFileName);
     }
     else
     {
-        if (sourceFile.copy(destinationFileName))
-        {
-            makeDateIdentical(sourceFileName, destinationFileName);
-            log(sourceFileName + " copied to " + destinationFileName);
-        }
+        if (copyFile(sourceFileName, destinationFileName)) log(sourceFileName + " copied to " + destinationFileName);
         else log(sourceFileName + " not possible to copy to " + destinationFileName);
     }
+    QFileInfo saved(destinationFileName);
+    if (!saved.exists()) return;
+    manifestEntry entry;
+    entry.size = saved.size();
+    entry.modified = modified;
+    entry.tail = tailChecksum(destinationFileName, entry.size);
+    manifest.insert(key, entry);
 }
 
 
@@ -113,55 +145,160 @@ void backup::saveFolder(QString source, QString destination, QString extension)
 {
     if (abort) return;
     QDir datDir = QDir(source);
-    QDir backupDir = QDir(destination);
     if (!QDir().exists(destination))
         if (!QDir().mkdir(destination)) return;
-    if (datDir.exists())
+    if (!datDir.exists()) return;
+    QStringList datfileslist = datDir.entryList(QDir::Files);
+    for (int n=0; n<datfileslist.count(); n++)
+    {
+        if (QFileInfo(datfileslist[n]).suffix() == extension)
+            saveFile(source + datfileslist[n], destination + QDir::separator() + datfileslist[n]);
+        if (abort) break;
+    }
+}
+
+
+
+
+// Copy to a temporary file then rename, a snapshot link keeps the previous version
+bool backup::copyFile(const QString &source, const QString &destination)
+{
+    QString part = destination + ".part";
+    QFile::remove(part);
+    if (!QFile::copy(source, part)) return false;
+    QFile::remove(destination);
+    if (!QFile::rename(part, destination)) return false;
+    makeDateIdentical(source, destination);
+    return true;
+}
+
+
+
+
+bool backup::appendTail(const QString &source, const QString &destination, qint64 from)
+{
+    QString target = destination;
+    bool shared = false;
+#ifdef Q_OS_LINUX
+    struct stat info;
+    if (stat(destination.toLocal8Bit(), &info) == 0) shared = (info.st_nlink > 1);
+#endif
+// file also linked in a snapshot : the snapshot version is left untouched
+    if (shared)
+    {
+        target = destination + ".part";
+        QFile::remove(target);
+        if (!QFile::copy(destination, target)) return false;
+    }
+    QFile sourceFile(source);
+    QFile destinationFile(target);
+    if (!sourceFile.open(QIODevice::ReadOnly)) return false;
+    if (!destinationFile.open(QIODevice::Append))
+    {
+        sourceFile.close();
+        return false;
+    }
+    bool ok = sourceFile.seek(from);
+    while (ok && !sourceFile.atEnd())
+    {
+        QByteArray chunk = sourceFile.read(65536);
+        if (chunk.isEmpty() || (destinationFile.write(chunk) != chunk.size())) ok = false;
+    }
+    sourceFile.close();
+    destinationFile.close();
+    if (!ok) return false;
+    if (shared)
     {
-        QStringList datfileslist = datDir.entryList(QDir::Files);
-        for (int n=0; n<datfileslist.count(); n++)
+        QFile::remove(destination);
+        if (!QFile::rename(target, destination)) return false;
+    }
+    makeDateIdentical(source, destination);
+    return true;
+}
+
+
+
+
+QByteArray backup::tailChecksum(const QString &fileName, qint64 size)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    qint64 from = qMax(qint64(0), size - backupTailCheck);
+    file.seek(from);
+    QByteArray data = file.read(size - from);
+    file.close();
+    if (data.size() != size - from) return QByteArray();
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+
+
+
+void backup::readManifest()
+{
+    manifest.clear();
+    QFile file(backupFolder + manifestFileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    while (!file.atEnd())
+    {
+        QStringList fields = QString::fromUtf8(file.readLine()).trimmed().split("\t");
+        if (fields.count() != 4) continue;
+        manifestEntry entry;
+        entry.size = fields.at(1).toLongLong();
+        entry.modified = fields.at(2).toLongLong();
+        entry.tail = fields.at(3).toLatin1();
+        manifest.insert(fields.at(0), entry);
+    }
+    file.close();
+}
+
+
+
+
+void backup::writeManifest()
+{
+    QString fileName = backupFolder + manifestFileName;
+    QFile file(fileName + ".new");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+    QHash <QString, manifestEntry>::const_iterator it;
+    for (it = manifest.constBegin(); it != manifest.constEnd(); ++it)
+        file.write((it.key() + QString("\t%1\t%2\t").arg(it.value().size).arg(it.value().modified) + QString::fromLatin1(it.value().tail) + "\n").toUtf8());
+    file.close();
+    QFile::remove(fileName);
+    QFile::rename(fileName + ".new", fileName);
+}
+
+
+
+
+// Each run is a folder of hard links to the backed up files, unchanged files cost no space
+void backup::makeSnapshot()
+{
+#ifdef Q_OS_LINUX
+    QString snapshots = backupFolder + backupSnapshotFolder;
+    if (!QDir().exists(snapshots))
+        if (!QDir().mkdir(snapshots)) return;
+    QString name = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    QString snapshot = snapshots + QDir::separator() + name + QDir::separator();
+    QSet <QString> folders;
+    int count = 0;
+    QHash <QString, manifestEntry>::const_iterator it;
+    for (it = manifest.constBegin(); it != manifest.constEnd(); ++it)
+    {
+        QString target = snapshot + it.key();
+        QString folder = QFileInfo(target).absolutePath();
+        if (!folders.contains(folder))
         {
-            QString sourceFileName = source + datfileslist[n];
-            QFile sourceFile(sourceFileName);
-            QFileInfo sourceInfo(sourceFile);
-            if (sourceInfo.suffix() == extension)
-            {
-                QString destinationFileName = destination + QDir::separator() + datfileslist[n];
-                QFile destinationFile(destinationFileName);
-                if (destinationFile.exists())
-                {
-                    QFileInfo destinationInfo(destinationFile);
-                    if (sourceInfo.fileTime(QFileDevice::FileModificationTime).secsTo(destinationInfo.fileTime(QFileDevice::FileModificationTime)) < 0)
-                    {
-                        QFile::remove(destinationFileName);
-                        if (sourceFile.copy(destinationFileName))
-                        {
-                            makeDateIdentical(sourceFileName, destinationFileName);
-                            log(sourceFileName + " overwrite " + destinationFileName);
-                        }
-                        else log(sourceFileName + " not possible to copy to " + destinationFileName);
-                    }
-                    else
-                    {
-                        if (sourceInfo.fileTime(QFileDevice::FileModificationTime).secsTo(destinationInfo.fileTime(QFileDevice::FileModificationTime)) == 0)
-                            log(sourceFileName + " skipped " + destinationFileName + " no change");
-                        else
-                            log(sourceFileName + " skipped " + destinationFileName + " is newer");
-                    }
-                }
-                else
-                {
-                    if (sourceFile.copy(destinationFileName))
-                    {
-                        makeDateIdentical(sourceFileName, destinationFileName);
-                        log(sourceFileName + " copied to " + destinationFileName);
-                    }
-                    else log(sourceFileName + " not possible to copy to " + destinationFileName);
-                }
-            }
-            if (abort) break;
+            QDir().mkpath(folder);
+            folders.insert(folder);
         }
+        if (::link(QString(backupFolder + it.key()).toLocal8Bit(), target.toLocal8Bit()) == 0) count++;
+        else log(it.key() + " not possible to link in snapshot " + name);
     }
+    log(QString("Snapshot %1 : %2 files").arg(name).arg(count));
+    QStringList list = QDir(snapshots).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    while (list.count() > backupSnapshots) QDir(snapshots + QDir::separator() + list.takeFirst()).removeRecursively();
+#endif
 }
 
 
@@ -182,14 +319,5 @@ void backup::makeDateIdentical(QString sourceFileName, QString destinationFileNa
 
 void backup::log(QString logStr)
 {
-    if (!logStr.isEmpty())
-    {
-        QFile logFile(backupFolder + logFileName);
-        if(logFile.open(QIODevice::Append | QIODevice::Text))
-        {
-            QTextStream out(&logFile);
-            out << logStr + "\n";
-            logFile.close();
-        }
-    }
+    if (!logStr.isEmpty()) logText += logStr + "\n";
 }
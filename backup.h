@@ -25,6 +25,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QHash>
 
 
 class backup : public QThread
@@ -33,7 +34,11 @@ class backup : public QThread
 #define backupDatFolder "dat"
 #define backupZipFolder "zip"
 #define backupIconFolder "png"
+#define backupSnapshotFolder "snapshots"
 #define logFileName "backup.log"
+#define manifestFileName "manifest.txt"
+#define backupSnapshots 14
+#define backupTailCheck 4096
 public:
     backup();
     ~backup();
@@ -48,6 +53,22 @@ public:
     QString configFileName;
     QString backupFolder;
     void log(QString logStr);
+private:
+// state of a backed up file at the end of the last run
+    struct manifestEntry
+    {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray tail;
+    };
+    QHash <QString, manifestEntry> manifest;
+    QString logText;
+    void readManifest();
+    void writeManifest();
+    static QByteArray tailChecksum(const QString &fileName, qint64 size);
+    bool copyFile(const QString &source, const QString &destination);
+    bool appendTail(const QString &source, const QString &destination, qint64 from);
+    void makeSnapshot();
 };
 
 #endif // BACKUP_H
@@ -0,0 +1,353 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+#include "bustransport.h"
+
+#define addTimeTag "\r" + QDateTime::currentDateTime().toString("HH:mm:ss:zzz  ") +
+
+
+
+bustransport::bustransport()
+{
+    owner = nullptr;
+    log = nullptr;
+    running = nullptr;
+    logEnabled = nullptr;
+    socket = nullptr;
+    serial = nullptr;
+    state = nullptr;
+    frameSize = nullptr;
+    backoff = linkMinBackoff;
+    bytesSent = 0;
+    bytesReceived = 0;
+    frames = 0;
+    timeouts = 0;
+    reconnects = 0;
+    latencyTotal = 0;
+    latencyMax = 0;
+}
+
+
+
+
+bustransport::~bustransport()
+{
+    delete serial;
+}
+
+
+
+
+void bustransport::setOwner(QObject *Owner, QString *Log, bool *Running, bool *LogEnabled)
+{
+    owner = Owner;
+    log = Log;
+    running = Running;
+    logEnabled = LogEnabled;
+}
+
+
+
+
+void bustransport::setSocket(QTcpSocket *Socket, QAbstractSocket::SocketState *State)
+{
+    socket = Socket;
+    state = State;
+}
+
+
+
+
+bool bustransport::openSerial(const QString &portName, qint32 baudRate)
+{
+    if (!serial) serial = new QSerialPort;
+    if (serial->isOpen()) serial->close();
+    serial->setPortName(portName);
+    serial->setBaudRate(baudRate);
+    serial->setDataBits(QSerialPort::Data8);
+    serial->setParity(QSerialPort::NoParity);
+    serial->setStopBits(QSerialPort::OneStop);
+    serial->setFlowControl(QSerialPort::NoFlowControl);
+    if (serial->open(QIODevice::ReadWrite))
+    {
+        addLog(addTimeTag portName + " opened");
+        return true;
+    }
+    addLog(addTimeTag portName + " open error : " + serial->errorString());
+    return false;
+}
+
+
+
+
+bool bustransport::connectLink(const QString &host, int port, const QString &Status)
+{
+    if (!socket) return false;
+    addLog(addTimeTag "TCP Connect  " + Status);
+    int tryConnect = 1;
+    do
+    {
+        addLog(addTimeTag QString("TCP try connect %1").arg(tryConnect));
+        if (socket->state() == QAbstractSocket::ConnectedState)
+        {
+            socket->disconnectFromHost();
+            addLog(addTimeTag "Try Disconnect");
+            if (socket->state() == QAbstractSocket::ConnectedState) socket->waitForDisconnected();
+        }
+        if (socket->state() == QAbstractSocket::UnconnectedState) addLog(addTimeTag "Disconnect OK");
+        setState(socket->state());
+        if (running && !*running) break;
+        socket->connectToHost(host, port);
+        addLog(addTimeTag "Try Connect");
+        socket->waitForConnected();
+        setState(socket->state());
+        if (socket->state() == QAbstractSocket::ConnectedState)
+        {
+            addLog(addTimeTag "Connect OK");
+            backoff = linkMinBackoff;
+            reconnects++;
+            return true;
+        }
+// Next attempt waits longer, up to one minute, so a dead gateway is not hammered
+        addLog(addTimeTag "Connection error : " + socket->errorString() + QString(", retry in %1s").arg(backoff / 1000));
+        wait(backoff);
+        backoff = qMin(backoff * 2, linkMaxBackoff);
+        tryConnect++;
+        if ((tryConnect > 10) && log) log->clear();
+        if (tryConnect > 10) tryConnect = 0;
+    }
+    while (!running || *running);
+    return false;
+}
+
+
+
+
+void bustransport::disconnectLink()
+{
+    if (socket)
+    {
+        socket->disconnectFromHost();
+        if (socket->state() != QAbstractSocket::UnconnectedState) socket->waitForDisconnected();
+        setState(socket->state());
+    }
+    if (serial && serial->isOpen()) serial->close();
+}
+
+
+
+
+bool bustransport::isConnected()
+{
+    if (serial && serial->isOpen()) return true;
+    if (socket) return (socket->state() == QAbstractSocket::ConnectedState);
+    return false;
+}
+
+
+
+
+QIODevice *bustransport::device()
+{
+    if (serial && serial->isOpen()) return serial;
+    return socket;
+}
+
+
+
+
+QSerialPort *bustransport::serialPort()
+{
+    return serial;
+}
+
+
+
+
+void bustransport::setTerminator(const QByteArray &Terminator)
+{
+    terminator = Terminator;
+    frameSize = nullptr;
+}
+
+
+
+
+void bustransport::setFrameSize(frameSizeFunction Function)
+{
+    frameSize = Function;
+    terminator.clear();
+}
+
+
+
+
+bool bustransport::frameComplete(const QByteArray &Data) const
+{
+    if (frameSize)
+    {
+        int length = frameSize(Data);
+        return ((length > 0) && (Data.length() >= length));
+    }
+    if (!terminator.isEmpty()) return Data.endsWith(terminator);
+    return false;
+}
+
+
+
+
+int bustransport::request(const QByteArray &Request, QByteArray &Answer, int timeout, int chunkTimeout)
+{
+    QIODevice *dev = device();
+    if (!dev || !isConnected()) return requestNotConnected;
+    dev->readAll();
+    if (dev->write(Request) != Request.length()) return requestWriteError;
+    if (!dev->waitForBytesWritten(5000)) return requestWriteError;
+    bytesSent += Request.length();
+    return readFrame(Answer, timeout, chunkTimeout);
+}
+
+
+
+
+int bustransport::readFrame(QByteArray &Data, int timeout, int chunkTimeout)
+{
+// timeout for the first byte, chunkTimeout between the next ones,
+// without frame strategy the answer ends with a silent chunkTimeout
+    QIODevice *dev = device();
+    if (!dev) return requestNotConnected;
+    if (chunkTimeout < 0) chunkTimeout = timeout;
+    QElapsedTimer clock;
+    clock.start();
+    int delay = timeout;
+    int received = Data.length();
+    while (!frameComplete(Data) && dev->waitForReadyRead(delay))
+    {
+        Data.append(dev->readAll());
+        delay = chunkTimeout;
+    }
+    bytesReceived += Data.length() - received;
+    if (Data.length() == received)
+    {
+        timeouts++;
+        return requestTimeout;
+    }
+    qint64 latency = clock.elapsed();
+    latencyTotal += latency;
+    if (latency > latencyMax) latencyMax = latency;
+    frames++;
+    if (!frameSize && terminator.isEmpty()) return requestDone;
+    if (frameComplete(Data)) return requestDone;
+    return requestPartial;
+}
+
+
+
+
+bool bustransport::send(const QByteArray &Request)
+{
+    QIODevice *dev = device();
+    if (!dev || !isConnected()) return false;
+    if (dev->write(Request) != Request.length()) return false;
+    if (!dev->waitForBytesWritten(5000)) return false;
+    bytesSent += Request.length();
+    return true;
+}
+
+
+
+
+// For callers matching answers themselves : what arrived within timeout
+// is appended, frameDone and frameLost then keep the counters
+bool bustransport::receive(QByteArray &Data, int timeout)
+{
+    QIODevice *dev = device();
+    if (!dev) return false;
+    if (!dev->bytesAvailable() && !dev->waitForReadyRead(timeout)) return false;
+    QByteArray chunk = dev->readAll();
+    bytesReceived += chunk.length();
+    Data.append(chunk);
+    return true;
+}
+
+
+
+
+void bustransport::frameDone(qint64 latency)
+{
+    frames++;
+    latencyTotal += latency;
+    if (latency > latencyMax) latencyMax = latency;
+}
+
+
+
+
+void bustransport::frameLost()
+{
+    timeouts++;
+}
+
+
+
+
+QString bustransport::statistics() const
+{
+    QString str = QString("Link : %1 frames, %2 timeouts, %3 bytes sent, %4 bytes received, %5 connections").arg(frames).arg(timeouts).arg(bytesSent).arg(bytesReceived).arg(reconnects);
+    if (frames) str += QString(", latency average %1 ms max %2 ms").arg(latencyTotal / frames).arg(latencyMax);
+    return str;
+}
+
+
+
+
+void bustransport::setState(QAbstractSocket::SocketState newState)
+{
+    if (state) *state = newState;
+    if (owner) QMetaObject::invokeMethod(owner, "tcpStatusChange", Qt::DirectConnection);
+}
+
+
+
+
+void bustransport::addLog(const QString &str)
+{
+    if (!log) return;
+    if (logEnabled && !*logEnabled) return;
+    log->append(str);
+}
+
+
+
+
+void bustransport::wait(int ms)
+{
+    QElapsedTimer clock;
+    clock.start();
+    while (clock.elapsed() < ms)
+    {
+        if (running && !*running) return;
+        QThread::msleep(100);
+    }
+}
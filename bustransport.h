@@ -0,0 +1,85 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+#ifndef BUSTRANSPORT_H
+#define BUSTRANSPORT_H
+#include <QtCore>
+#include <QTcpSocket>
+#include <QSerialPort>
+
+
+// Link used by the bus master threads : TCP socket or serial port,
+// reconnect with backoff, framed reads and traffic counters
+
+class bustransport
+{
+#define linkMinBackoff 1000
+#define linkMaxBackoff 60000
+public:
+    enum requestResult { requestDone, requestPartial, requestTimeout, requestWriteError, requestNotConnected };
+    typedef int (*frameSizeFunction)(const QByteArray &data);
+    bustransport();
+    ~bustransport();
+    void setOwner(QObject *Owner, QString *Log, bool *Running, bool *LogEnabled = nullptr);
+    void setSocket(QTcpSocket *Socket, QAbstractSocket::SocketState *State);
+    bool openSerial(const QString &portName, qint32 baudRate);
+    bool connectLink(const QString &host, int port, const QString &Status);
+    void disconnectLink();
+    bool isConnected();
+    QIODevice *device();
+    QSerialPort *serialPort();
+    void setTerminator(const QByteArray &Terminator);
+    void setFrameSize(frameSizeFunction Function);
+    int request(const QByteArray &Request, QByteArray &Answer, int timeout = 1000, int chunkTimeout = -1);
+    int readFrame(QByteArray &Data, int timeout, int chunkTimeout = -1);
+    bool send(const QByteArray &Request);
+    bool receive(QByteArray &Data, int timeout);
+    void frameDone(qint64 latency);
+    void frameLost();
+    QString statistics() const;
+    qint64 bytesSent;
+    qint64 bytesReceived;
+    int frames;
+    int timeouts;
+    int reconnects;
+    qint64 latencyTotal;
+    qint64 latencyMax;
+private:
+    QObject *owner;
+    QString *log;
+    bool *running;
+    bool *logEnabled;
+    QTcpSocket *socket;
+    QSerialPort *serial;
+    QAbstractSocket::SocketState *state;
+    QByteArray terminator;
+    frameSizeFunction frameSize;
+    int backoff;
+    bool frameComplete(const QByteArray &Data) const;
+    void setState(QAbstractSocket::SocketState newState);
+    void addLog(const QString &str);
+    void wait(int ms);
+};
+
+#endif // BUSTRANSPORT_H
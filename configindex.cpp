@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#include "globalvar.h"
+#include "configindex.h"
+
+
+
+configindex &configindex::instance()
+{
+    static configindex index;
+    return index;
+}
+
+
+
+
+QString configindex::block::value(const QString &key) const
+{
+    QString result = values.value(key);
+    if (result.startsWith("HEX:")) result = QString::fromUtf8(QByteArray::fromHex(result.mid(4).toLatin1()));
+    return result;
+}
+
+
+
+
+// Same blocks as the SearchLoopBegin / SearchLoopEnd scan, from "\n" + TAG_Begin to "\n" + TAG_End
+QStringList configindex::blocks(const QString &configdata, const QString &TAG_Begin, const QString &TAG_End)
+{
+    configindex &index = instance();
+    QMutexLocker locker(&index.mutex);
+    index.update(configdata);
+    QStringList list;
+    QList <QPair <int, int> > found = index.ranges(TAG_Begin, TAG_End);
+    for (int n=0; n<found.count(); n++) list.append(index.text.mid(found.at(n).first, found.at(n).second - found.at(n).first));
+    return list;
+}
+
+
+
+
+QList <configindex::block> configindex::deviceBlocks(const QString &configdata, const QString &RomID)
+{
+    configindex &index = instance();
+    QMutexLocker locker(&index.mutex);
+    index.update(configdata);
+    return index.devices.value(RomID);
+}
+
+
+
+
+void configindex::update(const QString &configdata)
+{
+    if ((text.constData() == configdata.constData()) && (text.length() == configdata.length())) return;
+    if (text == configdata) return;
+    text = configdata;
+    heads.clear();
+    tags.clear();
+    devices.clear();
+// One pass over the lines, a line is indexed by its key name or by the whole line for tags
+    int begin = text.indexOf('\n');
+    while (begin != -1)
+    {
+        int end = text.indexOf('\n', begin + 1);
+        int length = (end == -1) ? text.length() - begin - 1 : end - begin - 1;
+        QString line = text.mid(begin + 1, length);
+        int equal = line.indexOf(" = (");
+        heads[(equal == -1) ? line : line.left(equal)].append(begin);
+        begin = end;
+    }
+    QList <QPair <int, int> > found = ranges(One_Wire_Device, EndMark);
+    for (int n=0; n<found.count(); n++)
+    {
+        block device;
+        device.text = text.mid(found.at(n).first, found.at(n).second - found.at(n).first);
+        const QStringList blockLines = device.text.split("\n");
+        foreach (const QString &line, blockLines)
+        {
+            int equal = line.indexOf(" = (");
+            if (equal == -1) continue;
+            int close = line.indexOf(")", equal + 4);
+            if (close == -1) continue;
+            QString key = line.left(equal);
+            if (!device.values.contains(key)) device.values.insert(key, line.mid(equal + 4, close - equal - 4));
+        }
+        QString RomID = device.value("RomID");
+        if (!RomID.isEmpty()) devices[RomID].append(device);
+    }
+}
+
+
+
+
+// Offsets of the "\n" before every line starting with tag
+QVector <int> configindex::lines(const QString &tag)
+{
+    if (tags.contains(tag)) return tags.value(tag);
+    QVector <int> offsets;
+    QHash <QString, QVector <int> >::const_iterator it;
+    for (it = heads.constBegin(); it != heads.constEnd(); ++it)
+        if (it.key().startsWith(tag)) offsets += it.value();
+    std::sort(offsets.begin(), offsets.end());
+    tags.insert(tag, offsets);
+    return offsets;
+}
+
+
+
+
+QList <QPair <int, int> > configindex::ranges(const QString &TAG_Begin, const QString &TAG_End)
+{
+    QList <QPair <int, int> > found;
+    QVector <int> begins = lines(TAG_Begin);
+    QVector <int> ends = lines(TAG_End);
+    int from = 0;
+    for (int n=0; n<begins.count(); n++)
+    {
+        if (begins.at(n) < from) continue;
+        QVector <int>::const_iterator end = std::lower_bound(ends.constBegin(), ends.constEnd(), begins.at(n));
+        if (end == ends.constEnd()) break;
+        found.append(qMakePair(begins.at(n), *end));
+        from = *end;
+    }
+    return found;
+}
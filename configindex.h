@@ -0,0 +1,57 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#ifndef CONFIGINDEX_H
+#define CONFIGINDEX_H
+#include <QtCore>
+
+
+// Configuration text tokenized once : line offsets by tag or key name,
+// device blocks by RomID with their key values
+
+class configindex
+{
+public:
+    struct block
+    {
+        QString text;
+        QHash <QString, QString> values;
+        QString value(const QString &key) const;
+    };
+    static QStringList blocks(const QString &configdata, const QString &TAG_Begin, const QString &TAG_End);
+    static QList <block> deviceBlocks(const QString &configdata, const QString &RomID);
+private:
+    static configindex &instance();
+    void update(const QString &configdata);
+    QVector <int> lines(const QString &tag);
+    QList <QPair <int, int> > ranges(const QString &TAG_Begin, const QString &TAG_End);
+    QMutex mutex;
+    QString text;
+    QHash <QString, QVector <int> > heads;
+    QHash <QString, QVector <int> > tags;
+    QHash <QString, QList <block> > devices;
+};
+
+#endif // CONFIGINDEX_H
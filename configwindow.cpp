@@ -55,6 +55,7 @@
 #include "logisdom.h"
 #include "remote.h"
 #include "onewire.h"
+#include "scheduler.h"
 #include "programevent.h"
 #include "tableauconfig.h"
 #include "daily.h"
@@ -86,6 +87,7 @@ configwindow::configwindow(logisdom *Parent)
 	server = new Server(parent);
     configmanager = new configManager(parent, this, false);
 	flagCheckZipFiles = true;
+    zipCompactor.parent = parent;
     QGridLayout *ValueLayout = new QGridLayout(ui.tabWidget->widget(TabValues));
 	ValueLayout->addWidget(parent->mainTreeHtml, 1, 1, 1, 2);
 	lastPng = QDateTime::currentDateTime();
@@ -151,6 +153,8 @@ configwindow::configwindow(logisdom *Parent)
     connect(ui.comboBoxSize, SIGNAL(currentIndexChanged(int)), this, SLOT(pngResize(int)));
     connect(ui.checkBoxHtmlSize, SIGNAL(stateChanged(int)), this, SLOT(htmlEnabled(int)));
 	connect(ui.checkBoxHideHeating, SIGNAL(stateChanged(int)), this, SLOT(HideHeatingTab(int)));
+    connect(ui.spinBoxLogSize, SIGNAL(valueChanged(int)), this, SLOT(logSettingsChanged()));
+    connect(ui.comboBoxLogLevel, SIGNAL(currentIndexChanged(int)), this, SLOT(logSettingsChanged()));
 	connect(ui.lineEditHtmlTitleText, SIGNAL(textChanged(QString)), this, SLOT(updateHtmlPreview(QString)));
 	connect(ui.lineEditHtmlTitleCSS, SIGNAL(textChanged(QString)), this, SLOT(updateHtmlPreview(QString)));
 	connect(ui.lineEditHtmlHeaderCSS, SIGNAL(textChanged(QString)), this, SLOT(updateHtmlPreview(QString)));
@@ -196,10 +200,15 @@ configwindow::configwindow(logisdom *Parent)
     boutonBackupStr = ui.PushButtonBackupNow->text();
     connect(&backupTimer, SIGNAL(timeout()), this, SLOT(backupTimerTimeOut()));
     backupTimer.start(60000);
+// Device list and tree are rebuilt once after a burst of device creations or changes
+    deviceListTimer.setSingleShot(true);
+    deviceListTimer.setInterval(200);
+    connect(&deviceListTimer, SIGNAL(timeout()), this, SLOT(updateDeviceList()));
     connect(&fileBackup, SIGNAL(finished()), this, SLOT(backupFinished()));
     htmlEnabled(Qt::Unchecked);
 	pngResize(Qt::Unchecked);
 	pngEnabled(Qt::Unchecked);
+    logSettingsChanged();
     connect(&eMailSender, SIGNAL(logMessage(QString)), this, SLOT(logMailSender(QString)));
     connect(&smsSender, SIGNAL(logMessage(QString)), this, SLOT(logSMSSender(QString)));
 }
@@ -537,6 +546,13 @@ void configwindow::logSMSSender(QString msg)
     parent->GenError(91, msg);
 }
 
+
+
+void configwindow::logSettingsChanged()
+{
+    parent->setLogSettings(qint64(ui.spinBoxLogSize->value()) * 1000, ui.comboBoxLogLevel->currentIndex());
+}
+
 //http://127.0.0.1:1220/request=(GetMainMenu)user=()password=()command=()
 
 void configwindow::updateHtmlPreview(QString)
@@ -1055,6 +1071,7 @@ void configwindow::updateBanIPList()
 
 void configwindow::updateUsersList()
 {
+	server->updateUserIndex();
 	ui.listViewUsers->clear();
 	if (server->ConnectionUsers.count() > 0)
 	{
@@ -1262,66 +1279,100 @@ void configwindow::convert()
 
 void configwindow::setNextSave()
 {
-	QFile nextSaveFile("next.sav");
-	QTextStream out(&nextSaveFile);
-	if(nextSaveFile.open(QIODevice::WriteOnly | QIODevice::Text))
-	{
-		for (int n=0; n<devicePtArray.count(); n++)
-		{
-			out << devicePtArray[n]->getromid() + "#" + devicePtArray[n]->saveInterval.getNext() + "\n";
-		}
-		nextSaveFile.close();
-	}
+    scheduler::instance().save("next.sav");
 }
 
 
 
 
 void configwindow::valueTranslate(QString &txt)
+{
+    htmlTemplate page = getTemplate(txt);
+    renderTemplate(page, txt, "", false);
+}
+
+
+
+
+htmlTemplate configwindow::getTemplate(const QString &page)
 {
     QMutexLocker locker(&mutexTranslate);
-    QString newTxt = txt;
-    for (int n=0; n<devicePtArray.count(); n++)
+    if (templateCache.contains(page)) return templateCache.value(page);
+    if (templateCache.count() >= templateCacheMax) templateCache.clear();
+    htmlTemplate compiled(page);
+    templateCache.insert(page, compiled);
+    return compiled;
+}
+
+
+
+
+void configwindow::renderTemplate(const htmlTemplate &page, QString &txt, const QString &id, bool html)
+{
+    QString translatedHtml;
+    translatedHtml.reserve(page.pageLength + 256);
+    for (int n=0; n<page.segments.count(); n++)
     {
-        QString name = "[[" + devicePtArray.at(n)->getname() + "]]";
-        QString romid = "[[" + devicePtArray.at(n)->getromid() + "]]";
-        QString value = devicePtArray.at(n)->MainValueToStr();
-        int Lname = name.length();
-        int Lromid = romid.length();
-        bool foundname = true;
-        bool foundromid = true;
-        while (foundname | foundromid)
+        const htmlTemplate::segment &seg = page.segments.at(n);
+        switch (seg.type)
         {
-            int indexname = newTxt.indexOf(name);
-            if (indexname == -1) foundname = false;
-            else
+            case htmlTemplate::Literal : translatedHtml.append(seg.text); break;
+            case htmlTemplate::WebId : if (html) translatedHtml.append(id); break;
+            case htmlTemplate::DeviceTag :
             {
-                newTxt.remove(indexname, Lname);
-                newTxt.insert(indexname, value);
+                onewiredevice *device = DeviceExist(seg.text);
+                if (!device) device = Devicenameexist(seg.text);
+                if (device) translatedHtml.append(device->MainValueToStr());
+                else translatedHtml.append("[[" + seg.text + "]]");
             }
-            int indexromid = newTxt.indexOf(romid);
-            if (indexromid == -1) foundromid = false;
-            else
+            break;
+            case htmlTemplate::TreeTag :
             {
-                newTxt.remove(indexromid, Lromid);
-                newTxt.insert(indexromid, value);
+                if (html)
+                {
+                    QString command = seg.text;
+                    translatedHtml.append(parent->getHtmlValue(command));
+                }
+                else translatedHtml.append("[[" + seg.text + "]]");
             }
+            break;
         }
-        txt.clear();
-        txt.append(newTxt);
     }
-/*    int index = txt.indexOf("[[");
-    if (index != -1)
+    txt.clear();
+    txt.append(translatedHtml);
+}
+
+
+
+
+bool configwindow::webFileTranslate(const QString &fileName, QString &datHtml, const QString &id)
+{
+    QFileInfo info(fileName);
+    if (!info.exists()) return false;
+    htmlTemplate page;
+    bool cached = false;
+    mutexTranslate.lock();
+    if (webFileCache.contains(fileName))
+    {
+        page = webFileCache.value(fileName);
+        if ((page.lastModified == info.lastModified()) && (page.fileSize == info.size())) cached = true;
+    }
+    mutexTranslate.unlock();
+    if (!cached)
     {
-        int index_end = txt.indexOf("[[", index);
-        if (index_end != -1)
-        {
-            QString str = txt.mid(index, index_end - index);
-            txt = txt.remove(index, index_end - index);
-            QString tag = QDateTime::toString(str);
-            txt = txt.insert(tag);
-        }
-    }*/
+        QFile webFile(fileName);
+        if (!webFile.open(QIODevice::ReadOnly)) return false;
+        QTextStream in(&webFile);
+        page.compile(in.readAll());
+        webFile.close();
+        page.lastModified = info.lastModified();
+        page.fileSize = info.size();
+        QMutexLocker locker(&mutexTranslate);
+        if (webFileCache.count() >= templateCacheMax) webFileCache.clear();
+        webFileCache.insert(fileName, page);
+    }
+    renderTemplate(page, datHtml, id, true);
+    return true;
 }
 
 
@@ -1357,39 +1408,8 @@ void configwindow::replacewebid(QString &datHtml, const QString &id)
 void configwindow::htmlTranslate(QString &datHtml, const QString &id)
 {
 //parent->GenMsg("htmlTranslate id=" + id);
-	QString translatedHtml = datHtml;
-	int index = 0;
-	int ouv = translatedHtml.indexOf("[[", index);
-	while (ouv > 0)
-	{
-		index = ouv + 2;
-		int ferm = translatedHtml.indexOf("]]", index);
-		if (ferm > 0)
-		{
-			QString str = translatedHtml.mid(ouv + 2, ferm - ouv - 2);
-			QStringList split = str.split(htmlsperarator);
-			if (split.count() == 1)
-			{
-				onewiredevice *device = DeviceExist(str);
-				if (!device) device = Devicenameexist(str);
-				if (device)
-				{
-					QString value = device->MainValueToStr();
-					translatedHtml.remove(ouv, ferm - ouv + 2);
-					translatedHtml.insert(ouv, value);
-				}
-			}
-			else if (split.count() > 1)
-			{
-				translatedHtml.remove(ouv, ferm - ouv + 2);
-				translatedHtml.insert(ouv, parent->getHtmlValue(str));
-			}
-		}
-		ouv = translatedHtml.indexOf("[[", index);
-	}
-	replacewebid(translatedHtml, id);
-	datHtml.clear();
-	datHtml.append(translatedHtml);
+    htmlTemplate page = getTemplate(datHtml);
+    renderTemplate(page, datHtml, id, true);
 }
 
 
@@ -1405,10 +1425,15 @@ void configwindow::checkDatZipFile()
 	}
 	// Check zip files in enabled
 	if (!flagCheckZipFiles) return;
+	// Compaction runs in zipCompactor, devices being reprocessed are retried next time
+	bool reprocessing = false;
+	zipCompactor.setFolders(parent->getrepertoiredat(), parent->getrepertoirezip());
 	for (int n=0; n<devicePtArray.count(); n++)
 	{
-		if (devicePtArray[n]->zipPreviousDatFile()) return;
+		if (devicePtArray[n]->isReprocessing()) reprocessing = true;
+		else zipCompactor.append(devicePtArray[n]->getromid());
 	}
+	if (reprocessing) return;
 	// Wait until next month
 	flagCheckZipFiles = false;
 }
@@ -1418,9 +1443,8 @@ void configwindow::checkDatZipFile()
 
 void configwindow::LectureVD()
 {
-	for (int n=0; n<devicePtArray.count(); n++)
-		if (devicePtArray[n]->isVirtualFamily())
-			devicePtArray[n]->lecture();
+	foreach (onewiredevice *device, deviceRegistry.byFamily(familyVirtual))
+		device->lecture();
 }
 
 
@@ -1429,20 +1453,16 @@ void configwindow::LectureVD()
 
 void configwindow::LectureRecVD()
 {
-	for (int n=0; n<devicePtArray.count(); n++)
-		if (devicePtArray[n]->isVirtualFamily())
-			devicePtArray[n]->lecturerec();
+	foreach (onewiredevice *device, deviceRegistry.byFamily(familyVirtual))
+		device->lecturerec();
 }
 
 
 
 bool configwindow::deviceexist(const QString &RomID)
 {
-	QMutexLocker locker(&mutex);
     if (RomID == "") return false;
-	for (int n=0; n<devicePtArray.count(); n++)
-        if (devicePtArray[n]->getromid() == RomID) return true;
-	return false;
+    return (deviceRegistry.byRomID(RomID) != nullptr);
 }
 
 
@@ -1451,11 +1471,8 @@ bool configwindow::deviceexist(const QString &RomID)
 
 bool configwindow::deviceexist(onewiredevice *device)
 {
-	QMutexLocker locker(&mutex);
 	if (!device) return false;
-	for (int n=0; n<devicePtArray.count(); n++)
-        if (devicePtArray[n] == device) return true;
-	return false;
+    return deviceRegistry.contains(device);
 }
 
 
@@ -1463,31 +1480,22 @@ bool configwindow::deviceexist(onewiredevice *device)
 
 onewiredevice *configwindow::DeviceExist(const QString &RomID)
 {
-    if (deviceList.contains(RomID)) return deviceList[RomID];
-    //QMutexLocker locker(&mutex);
-    //if (RomID == "") return nullptr;
-    //for (int n=0; n<devicePtArray.count(); n++)
-    //	if (devicePtArray[n]->getromid() == RomID) return devicePtArray[n];
-	return nullptr;
+    return deviceRegistry.byRomID(RomID);
+}
+
+
+
+void configwindow::renameDevice(onewiredevice *device)
+{
+    deviceRegistry.rename(device);
 }
 
 
 
 onewiredevice *configwindow::EoDeviceExist(const QString &RomID)
 {
-    QMutexLocker locker(&mutex);
     if (RomID == "") return nullptr;
-    if (RomID.contains("_"))
-    {
-        for (int n=0; n<devicePtArray.count(); n++)
-            if ((devicePtArray[n]->getromid().left(10) == RomID.left(10)) && (devicePtArray[n]->getromid().right(4) == RomID.right(4))) return devicePtArray[n];
-    }
-    else
-    {
-        for (int n=0; n<devicePtArray.count(); n++)
-            if ((devicePtArray[n]->getromid().left(10) == RomID.left(10)) && (devicePtArray[n]->getromid().right(2) == RomID.right(2))) return devicePtArray[n];
-    }
-    return nullptr;
+    return deviceRegistry.byEnOceanID(RomID);
 }
 
 
@@ -1495,12 +1503,8 @@ onewiredevice *configwindow::EoDeviceExist(const QString &RomID)
 
 bool configwindow::devicenameexist(const QString &Name)
 {
-	QMutexLocker locker(&mutex);
 	if (Name == "") return true;
-	for (int n=0; n<devicePtArray.count(); n++)
-			if (devicePtArray[n]->getname() == Name)
-				return true;
-	return false;
+    return (deviceRegistry.byName(Name) != nullptr);
 }
 
 
@@ -1510,12 +1514,8 @@ bool configwindow::devicenameexist(const QString &Name)
 
 onewiredevice *configwindow::Devicenameexist(const QString &Name)
 {
-	QMutexLocker locker(&mutex);
 	if (Name == "") return nullptr;
-	for (int n=0; n<devicePtArray.count(); n++)
-			if (devicePtArray[n]->getname() == Name)
-				return devicePtArray[n];
-	return nullptr;
+    return deviceRegistry.byName(Name);
 }
 
 
@@ -1523,9 +1523,8 @@ onewiredevice *configwindow::Devicenameexist(const QString &Name)
 QString configwindow::getDeviceName(QString &RomID)
 {
 	if (RomID == "") return "";
-	for (int n=0; n<devicePtArray.count(); n++)
-			if (devicePtArray[n]->getromid() == RomID)
-				return devicePtArray[n]->getname();
+    onewiredevice *device = deviceRegistry.byRomID(RomID);
+    if (device) return device->getname();
 	return "";
 }
 
@@ -1546,7 +1545,7 @@ onewiredevice *configwindow::NewPluginDevice(const QString &RomID, LogisDomInter
     device->WarnEnabled.hide();
     device->setPluginInterface(interface);
     devicePtArray.append(device);
-    deviceList.insert(RomID, device);
+    deviceRegistry.add(device);
     connect(device, SIGNAL(DeviceConfigChanged(onewiredevice*)), parent, SLOT(DeviceConfigChanged(onewiredevice*)));
     device->setHtmlMenulist(ui.listWidget);
     QString configdata;
@@ -1559,7 +1558,7 @@ onewiredevice *configwindow::NewPluginDevice(const QString &RomID, LogisDomInter
     connect(device, SIGNAL(saveDat(QString, QString)), parent, SLOT(saveDat(QString, QString)), Qt::QueuedConnection);
     if (!interface->acceptCommand(RomID)) { device->SendButton.hide(); device->command.hide(); }
     emit(DeviceChanged(device));
-    updateDeviceList();
+    deviceListTimer.start();
     return device;
 }
 
@@ -1651,7 +1650,7 @@ onewiredevice *configwindow::NewDevice(const QString &newRomID, net1wire *master
     else return nullptr; //device = new onewiredevice(master, RomID);
     if (!device) return nullptr;
 	devicePtArray.append(device);
-    deviceList.insert(RomID, device);
+    deviceRegistry.add(device);
 	connect(device, SIGNAL(DeviceConfigChanged(onewiredevice*)), parent, SLOT(DeviceConfigChanged(onewiredevice*)));
 	if (!parent->isRemoteMode())
 	{
@@ -1796,7 +1795,7 @@ void configwindow::setPalette(QListWidgetItem* item)
 void configwindow::DeviceConfigChanged(onewiredevice *device)
 {
 	emit(DeviceChanged(device));
-	updateDeviceList();
+	deviceListTimer.start();
 }
 
 
@@ -2112,9 +2111,8 @@ void configwindow::removeVD()
 {
 	bool ok;
 	QStringList items;
-	for (int n=0; n<devicePtArray.count(); n++)
-		if (devicePtArray[n]->getromid().right(2) == familyVirtual)
-			items << devicePtArray[n]->getname();
+	foreach (onewiredevice *device, deviceRegistry.byFamily(familyVirtual))
+		items << device->getname();
 	if (items.count() == 0) return;
     QString item = inputDialog::getItemPalette(this, tr("Remove Virtual Device"), tr("Device : "), items, 0, false, &ok, parent);
 	if (!ok) return;
@@ -2130,12 +2128,9 @@ void configwindow::removeVD()
 		if (index != -1)
 		{
 			net1wire *master = devicePtArray.at(index)->getMaster();
-			if (master)
-			{
-				/// remove from localdevice
-			}
+			if (master) master->removeDeviceFromCatalog(device);
 			devicePtArray.removeAt(index);
-            deviceList.remove(device->getromid());
+            deviceRegistry.remove(device);
 			updateDeviceList();
 			device->close();
 		}
@@ -2505,6 +2500,9 @@ void configwindow::readGeneralConfig(QString &configdata)
     if ((ok) && (HideHeatingTab)) ui.checkBoxHideHeating->setCheckState(Qt::Checked);
     int LogFileSize = logisdom::getvalue("LogFileSize", strsearch).toInt(&ok);
     if ((ok) && (LogFileSize)) ui.spinBoxLogSize->setValue(LogFileSize);
+    int LogLevel = logisdom::getvalue("LogLevel", strsearch).toInt(&ok);
+    if ((ok) && (LogLevel >= 0) && (LogLevel < ui.comboBoxLogLevel->count())) ui.comboBoxLogLevel->setCurrentIndex(LogLevel);
+    logSettingsChanged();
     int ColWidth = logisdom::getvalue("TreeDevivceColumWidth", strsearch).toInt(&ok);
     if ((ok) && (ColWidth > 20)) OneWireTree.setColumnWidth(0, ColWidth);
     else OneWireTree.setColumnWidth(0, 200);
@@ -3221,17 +3219,15 @@ void configwindow::GetDevicesStr(QString &str)
 
 void configwindow::SetDevicesScratchpad(const QString &configdata, bool save)
 {
-	QString ReadRomID, Scratchpad;
-	QString TAG_Begin = One_Wire_Device;
-	QString TAG_End = EndMark;
+	QString Scratchpad;
 	for (int n=0; n<devicePtArray.count(); n++)
 	{
-		SearchLoopBegin
-		ReadRomID = logisdom::getvalue(RomIDTag, strsearch);
-		Scratchpad = logisdom::getvalue(ScratchPadMark, strsearch);
-		if ((ReadRomID == devicePtArray[n]->getromid()) and (!Scratchpad.isEmpty()))
-			devicePtArray[n]->setscratchpad(Scratchpad, save);
-		SearchLoopEnd
+		QList <configindex::block> blocks = configindex::deviceBlocks(configdata, devicePtArray[n]->getromid());
+		foreach (const configindex::block &block, blocks)
+		{
+			Scratchpad = logisdom::getvalue(ScratchPadMark, block.text);
+			if (!Scratchpad.isEmpty()) devicePtArray[n]->setscratchpad(Scratchpad, save);
+		}
 	}
 }
 
@@ -3416,6 +3412,7 @@ void configwindow::SaveConfigStr(QString &str)
     str += logisdom::saveformat(QString("SaveInterval"), QString("%1").arg(ui.spinBoxSaveInterval->value()));
 	if (ui.checkBoxHideHeating->isChecked()) str += logisdom::saveformat("HideHeatingTab", "1"); else str += logisdom::saveformat("HideHeatingTab", "0");
 	str += logisdom::saveformat(QString("LogFileSize"), QString("%1").arg(ui.spinBoxLogSize->value()));
+	str += logisdom::saveformat(QString("LogLevel"), QString("%1").arg(ui.comboBoxLogLevel->currentIndex()));
 	str += logisdom::saveformat(QString("TreeDevivceColumWidth"), QString("%1").arg(OneWireTree.columnWidth(0)));
 	parent->alarmwindow->GeneralErrorLog->getCfgStr(str);
     str += logisdom::saveformat("TextCodec", ui.comboBoxCodecs->currentText());
@@ -3450,19 +3447,16 @@ void configwindow::SaveConfigStr(QString &str)
 void configwindow::readconfigfilefordevice(const QString &configdata, onewiredevice *device)
 {
     QMutexLocker locker(&mutexReadConfig);
-	QString ReadRomID;
-	QString Name;
-	QString TAG_Begin = One_Wire_Device;
-	QString TAG_End = EndMark;
 	if (device == nullptr) return;
-	SearchLoopBegin
-    ReadRomID = logisdom::getvalue("RomID", strsearch);
-	if (ReadRomID == device->getromid())
+    QString RomID = device->getromid();
+    loadNextSave();
+    QList <configindex::block> blocks = configindex::deviceBlocks(configdata, RomID);
+    foreach (const configindex::block &block, blocks)
 	{
+        QString strsearch = block.text;
         device->setCfgStr(strsearch);
-        QFile nextSaveFile("next.sav");
-        if (ReadRomID.right(2) == "MD") {   // this is only to import Modbus device with modbus plugin
-            QString coefstr = logisdom::getvalue("Coef", strsearch);
+        if (RomID.right(2) == "MD") {   // this is only to import Modbus device with modbus plugin
+            QString coefstr = block.value("Coef");
             bool ok;
             if (!coefstr.isEmpty()) {
                 if (coefstr.toDouble(&ok) != 1) {
@@ -3470,23 +3464,33 @@ void configwindow::readconfigfilefordevice(const QString &configdata, onewiredev
                 device->AXplusB.A.setText(coefstr); }
             }
         }
-		if (nextSaveFile.open(QIODevice::ReadOnly | QIODevice::Text))
-		{
-			while(!nextSaveFile.atEnd())
-			{
-				QString line = nextSaveFile.readLine();
-				QStringList split = line.split("#");
-				if (split.count() == 2)
-				{
-					if (split.first() == ReadRomID) device->saveInterval.setNext(QDateTime::fromString (split.at(1), Qt::ISODate));
-				}
-			}
-            nextSaveFile.close();
-        }
+        if (nextSave.contains(RomID)) device->saveInterval.setNext(nextSave.value(RomID));
 	}
-	SearchLoopEnd
-	strsearch = "";
-    if (device->getname().isEmpty()) device->setconfig(strsearch);
+    if (device->getname().isEmpty()) device->setconfig(QString());
+}
+
+
+
+
+// next.sav is parsed again only when the file changed
+void configwindow::loadNextSave()
+{
+    QFileInfo info("next.sav");
+    QDateTime modified = info.exists() ? info.lastModified() : QDateTime();
+    if (modified == nextSaveModified) return;
+    nextSaveModified = modified;
+    nextSave.clear();
+    QFile nextSaveFile("next.sav");
+    if (nextSaveFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        while(!nextSaveFile.atEnd())
+        {
+            QString line = nextSaveFile.readLine();
+            QStringList split = line.split("#");
+            if (split.count() == 2) nextSave.insert(split.first(), QDateTime::fromString(split.at(1), Qt::ISODate));
+        }
+        nextSaveFile.close();
+    }
 }
 
 
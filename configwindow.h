@@ -32,9 +32,12 @@
 
 #include "ui_configgui.h"
 #include "backup.h"
+#include "zipcompactor.h"
+#include "deviceregistry.h"
 #include "pngthread.h"
 #include "sendmailthread.h"
 #include "sendsmsthread.h"
+#include "htmltemplate.h"
 #include "../plugins/interface.h"
 
 class net1wire;
@@ -114,13 +117,13 @@ struct htmlSetup
     onewiredevice *NewPluginDevice(const QString &newRomID, LogisDomInterface *);
     onewiredevice *NewDevice(const QString &RomID, net1wire *master);
     void UpdateRemoteDevice(const QString &configdata);
-	void updateDeviceList();
     QTimer backupTimer;
     QStringList fileToBackup;
     QList<ipInt*> suspectIP;
     bool deviceexist(const QString &RomID);
 	bool deviceexist(onewiredevice *device);
 	onewiredevice *DeviceExist(const QString &RomID);
+    void renameDevice(onewiredevice *device);
     onewiredevice *EoDeviceExist(const QString &RomID);
     bool devicenameexist(const QString &Name);
 	onewiredevice *Devicenameexist(const QString &Name);
@@ -177,6 +180,7 @@ struct htmlSetup
 	void replacewebid(QString &datHtml, const QString &id);
 	void htmlTranslate(QString &datHtml, const QString &id);
 	void valueTranslate(QString &txt);
+    bool webFileTranslate(const QString &fileName, QString &datHtml, const QString &id);
     QMutex mutexTranslate;
     QMutex ConnectionMutex;
     onewiredevice *chooseDevice();
@@ -195,9 +199,18 @@ private:
     void updateBanIPList();
     void updateUsersList();
     void readconfigfilefordevice(const QString &configdata, onewiredevice *device);
+    void loadNextSave();
+    QTimer deviceListTimer;
+    QHash <QString, QDateTime> nextSave;
+    QDateTime nextSaveModified;
+#define templateCacheMax 64
+    QHash <QString, htmlTemplate> templateCache;
+    QHash <QString, htmlTemplate> webFileCache;
+    htmlTemplate getTemplate(const QString &page);
+    void renderTemplate(const htmlTemplate &page, QString &txt, const QString &id, bool html);
 	QList <net1wire*> net1wirearray;
     QList <onewiredevice*> devicePtArray;
-    QHash <QString, onewiredevice*> deviceList;
+    deviceregistry deviceRegistry;
     QComboBox net1wireList;
 	net1wire *newmaster(QString Name, int Type);
 	void addUser();
@@ -209,6 +222,7 @@ private:
     onewiredevice *addVD(QString name = "");
     pngthread savePng;
     backup fileBackup;
+    zipcompactor zipCompactor;
     QString boutonBackupStr;
     QString mailPsw;
     void Lock(bool state);
@@ -270,7 +284,9 @@ private slots:
     void backupTimerTimeOut();
     void logMailSender(QString);
     void logSMSSender(QString);
+    void logSettingsChanged();
 public slots:
+	void updateDeviceList();
 	void DeviceConfigChanged(onewiredevice *device);
 	void DeviceValueChanged(onewiredevice *device);
 	void ProgHasChanged(ProgramData *prog);
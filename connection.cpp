@@ -202,26 +202,20 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 	QString user = logisdom::getvalue(CUser, Data);
 	QString password = logisdom::getvalue(CPsw, Data);
 	QString id = logisdom::getvalue(CUId, Data);
-	int indexID = -1;
-	int indexUser = -1;
-	int count = Parent->ConnectionUsers.count();
+	Server::UserIDs session;
 	if (!user.isEmpty())
 	{
-		for (int n=0; n<count; n++)
-				if (Parent->ConnectionUsers[n].Name == user) indexUser = n;
+		int indexUser = Parent->findUser(user);
 		if (indexUser != -1)
 			if (Parent->ConnectionUsers[indexUser].PassWord == password)
 				// Generate new ID when user and password is verifed
-				{
-					indexID = Parent->GetNewId(indexUser);
-					id = Parent->ConnectionIDs[indexID].WebID;
-				}
+				id = Parent->GetNewId(indexUser);
 	}
-	// if user and password failed check is ID is valabe
-	if (indexID == -1) indexID = Parent->isIDValable(id);
+	// check is ID is valabe
+	bool validID = Parent->isIDValable(id, session);
 	// Direct request without password check
     int PngRotation = 0;
-    if (indexID == -1)
+    if (!validID)
 	{
         // Rotated icon request check
         QStringList split = Data.split(".");
@@ -243,19 +237,11 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 		if ((!done) && (Data.right(4) == ".gif")) done = writeWebFile(Data, "gif");
 		if (!done)
 		{
-			QFile webFile(webFolder + Data);
-			if (webFile.exists())
+			QString text;
+			if (Parent->parent->configwin->webFileTranslate(webFolder + Data, text, id))
 			{
-                if (webFile.open(QIODevice::ReadOnly | QIODevice::Text))
-                {
-                    QTextStream in(&webFile);
-                    QString text;
-                    text = in.readAll();
-                    webFile.close();
-                    Parent->parent->htmlTranslate(text, id);
-                    str->append(text);
-                    Parent->setLastPageWeb(id, request);
-                }
+                str->append(text);
+                Parent->setLastPageWeb(id, request);
             }
 			else
 			{
@@ -284,7 +270,7 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 			{
                 QString command = Data.remove(0, indexstart + 9);
                 command = command.mid(0, indexend - indexstart - 9);
-                if (Parent->ConnectionIDs[indexID].Rigths == Server::FullControl) Parent->parent->htmlLinkCommand(command);
+                if (session.Rigths == Server::FullControl) Parent->parent->htmlLinkCommand(command);
                 request = Parent->getLastPageWeb(id);
                 QFile webFile(webFolder + request);
                 int page = maison1wirewindow->htmlPageExist(request);
@@ -296,15 +282,11 @@ void Connection::extractrequest(QByteArray &data, QString *str)
                     str->append(html);
                     Parent->setLastPageWeb(id, request);
                 }
-                else if (webFile.exists())
+                else
                 {
-                    if (webFile.open(QIODevice::ReadOnly))
+                    QString text;
+                    if (Parent->parent->configwin->webFileTranslate(webFile.fileName(), text, id))
                     {
-                        QTextStream in(&webFile);
-                        QString text;
-                        text = in.readAll();
-                        webFile.close();
-                        Parent->parent->htmlTranslate(text, id);
                         str->append(text);
                         Parent->setLastPageWeb(id, request);
                     }
@@ -332,6 +314,15 @@ void Connection::extractrequest(QByteArray &data, QString *str)
             str->append(html);
             Parent->setLastPageWeb(id, request);
         }
+        else if (trans && webFile.exists())
+		{
+            QString text;
+            if (Parent->parent->configwin->webFileTranslate(webFile.fileName(), text, id))
+            {
+                str->append(text);
+                Parent->setLastPageWeb(id, request);
+            }
+        }
         else if (webFile.exists())
 		{
             if (webFile.open(QIODevice::ReadOnly))
@@ -340,7 +331,6 @@ void Connection::extractrequest(QByteArray &data, QString *str)
                 QString text;
                 text = in.readAll();
                 webFile.close();
-                if (trans) Parent->parent->htmlTranslate(text, id);
                 str->append(text);
                 Parent->setLastPageWeb(id, request);
             }
@@ -353,7 +343,7 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 		return;
 	}
 // htmlRemote
-	str->append(maison1wirewindow->getHtmlRequest(Data, Parent->ConnectionIDs[indexID].WebID, Parent->ConnectionIDs[indexID].Rigths));
+	str->append(maison1wirewindow->getHtmlRequest(Data, session.WebID, session.Rigths));
 // X10 ...
 	if (request == NetRequestMsg[SetDevice])
 	{
@@ -362,14 +352,14 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 		if (device)
 		{
 			device->SetOrder(logisdom::getvalue("order", Data));
-			request = Parent->ConnectionIDs[indexID].LastMenu;
+			request = session.LastMenu;
 		}
 	}
 // eco confort ...
 	if (request == NetRequestMsg[SwitchProgram])
 	{
 		maison1wirewindow->ProgEventArea->SwitchPrg(logisdom::getvalue(SetPrgMark, Data));
-		request = Parent->ConnectionIDs[indexID].LastMenu;
+		request = session.LastMenu;
 	}
 // ConfirmRestart
 	if (request == NetRequestMsg[ConfirmRestart])
@@ -379,8 +369,8 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 		return;
 	}
 // add Main menu from confiwin according request
-	maison1wirewindow->configwin->GetMenuHtml(&txt, Parent->ConnectionIDs[indexID].WebID, Parent->ConnectionIDs[indexID].Rigths, request);
-	Parent->ConnectionIDs[indexID].LastMenu = request ;
+	maison1wirewindow->configwin->GetMenuHtml(&txt, session.WebID, session.Rigths, request);
+	Parent->setLastMenu(id, request);
 	str->append(txt);
 	if (str->isEmpty()) str->append(tr("Error"));
 	return;
@@ -391,7 +381,7 @@ void Connection::extractrequest(QByteArray &data, QString *str)
 
 bool Connection::writeWebFile(const QString &Data, const QString &type)
 {
-	QString str;
+    Server::cachedResponse response;
     QStringList strSplit = Data.split(".");
     if (strSplit.count() > 2)
     {
@@ -402,27 +392,33 @@ bool Connection::writeWebFile(const QString &Data, const QString &type)
             bool ok;
             int rotation = strR.toInt(&ok);
             QString fileName = Data.right(Data.length() - strRotation.length() - 1);
-            QFile picture(fileName);
+            QFileInfo picture(fileName);
             if (picture.exists())
             {
                 //qDebug() << fileName;
-                str.append("HTTP/1.0 200 OK\r\n");
-                str.append("Content-type: image/" + type  + "\r\n\r\n");
+                QString key = QString("R=%1.").arg(rotation) + fileName;
+                if (Parent->getCachedResponse(key, response))
+                    if ((response.lastModified == picture.lastModified()) && (response.fileSize == picture.size()))
+                    {
+                        writeCachedResponse(response);
+                        return true;
+                    }
                 QPixmap pixmap;
                 pixmap.load(fileName);
                 if (pixmap.isNull()) return false;
                 QTransform t;
                 t.rotate(rotation);
                 QPixmap RotatedPixmap = pixmap.transformed(t);
-                QByteArray bytes;
-                QBuffer buffer(&bytes);
+                QBuffer buffer(&response.body);
                 buffer.open(QIODevice::ReadWrite);
                 RotatedPixmap.save(&buffer, "PNG"); // writes pixmap into bytes in PNG format
-                if (tcp->isValid()) tcp->write(str.toUtf8());
-                tcp->waitForBytesWritten(10000);
-                buffer.reset();
-                if (tcp->isValid()) tcp->write(buffer.readAll());
-                tcp->waitForBytesWritten(10000);
+                buffer.close();
+                response.contentType = "image/" + type.toLatin1();
+                response.lastModified = picture.lastModified();
+                response.fileSize = picture.size();
+                response.revision = -1;
+                Parent->putCachedResponse(key, response);
+                writeCachedResponse(response);
                 return true;
             }
             else return false;
@@ -433,15 +429,23 @@ bool Connection::writeWebFile(const QString &Data, const QString &type)
     //qDebug() << Data;
     if (webFile.exists())
 	{
-		str.append("HTTP/1.0 200 OK\r\n");
-		str.append("Content-type: image/" + type  + "\r\n\r\n");
+        QFileInfo info(webFile);
+        if (Parent->getCachedResponse(webFile.fileName(), response))
+            if ((response.lastModified == info.lastModified()) && (response.fileSize == info.size()))
+            {
+                writeCachedResponse(response);
+                return true;
+            }
 		if (webFile.open(QIODevice::ReadOnly))
 		{
-            if (tcp->isValid()) tcp->write(str.toUtf8());
-            tcp->waitForBytesWritten(10000);
-            if (tcp->isValid()) tcp->write(webFile.readAll());
-            tcp->waitForBytesWritten(10000);
+            response.body = webFile.readAll();
             webFile.close();
+            response.contentType = "image/" + type.toLatin1();
+            response.lastModified = info.lastModified();
+            response.fileSize = info.size();
+            response.revision = -1;
+            Parent->putCachedResponse(webFile.fileName(), response);
+            writeCachedResponse(response);
 			return true;
 		}
 	}
@@ -454,22 +458,31 @@ bool Connection::writeWebFile(const QString &Data, const QString &type)
 // complete page html converted to png
 bool Connection::writePng(const QString &Data)
 {
-	QString str;
 	int l = Data.length();
 	QString name = Data.mid(0, l - 4);
+    QString key = maison1wirewindow->getTabPixKey(name);
+    Server::cachedResponse response;
+// icon tabs are only grabbed again when one of their icons has changed
+    qint64 revision = maison1wirewindow->getTabRevision(name);
+    if ((revision != -1) && Parent->getCachedResponse(key, response))
+        if (response.revision == revision)
+        {
+            writeCachedResponse(response);
+            return true;
+        }
 	QBuffer buffer;
     buffer.open(QIODevice::ReadWrite);
     maison1wirewindow->getTabPix(name, buffer);
     if (buffer.size())
 	{
-		str.append("HTTP/1.0 200 OK\r\n");
-		str.append("Content-type: image/png\r\n\r\n");
-		buffer.reset();
-        if (tcp->isValid()) tcp->write(str.toUtf8());
-        tcp->waitForBytesWritten(10000);
-        if (tcp->isValid()) tcp->write(buffer.readAll());
-        tcp->waitForBytesWritten(10000);
+        response.body = buffer.data();
         buffer.close();
+        response.contentType = "image/png";
+        response.fileSize = response.body.size();
+        response.revision = revision;
+        if (revision != -1) Parent->putCachedResponse(key, response);
+        else response.etag.clear();
+        writeCachedResponse(response);
 		return true;
 	}
 	return false;
@@ -478,6 +491,36 @@ bool Connection::writePng(const QString &Data)
 
 
 
+void Connection::writeCachedResponse(const Server::cachedResponse &response)
+{
+	QString str;
+    if (!response.etag.isEmpty() && (ifNoneMatch == response.etag))
+    {
+        str.append("HTTP/1.0 304 Not Modified\r\n");
+        str.append("ETag: " + response.etag + "\r\n\r\n");
+        if (tcp->isValid()) tcp->write(str.toUtf8());
+        tcp->waitForBytesWritten(10000);
+        return;
+    }
+    str.append("HTTP/1.0 200 OK\r\n");
+    str.append("Content-type: " + response.contentType + "\r\n");
+    if (!response.etag.isEmpty())
+    {
+        str.append("ETag: " + response.etag + "\r\n");
+        str.append("Cache-Control: no-cache\r\n");
+    }
+    if (response.lastModified.isValid())
+        str.append("Last-Modified: " + QLocale::c().toString(response.lastModified.toUTC(), "ddd, dd MMM yyyy hh:mm:ss 'GMT'") + "\r\n");
+    str.append("\r\n");
+    if (tcp->isValid()) tcp->write(str.toUtf8());
+    tcp->waitForBytesWritten(10000);
+    if (tcp->isValid()) tcp->write(response.body);
+    tcp->waitForBytesWritten(10000);
+}
+
+
+
+
 void Connection::processReadyRead()
 {
     QString Msg, extract, order;
@@ -502,6 +545,14 @@ more:
 		{
 			isHttp = true;
 			maison1wirewindow->GenMsg("http request detected = ");
+			ifNoneMatch.clear();
+			int match = data.toLower().indexOf("if-none-match:");
+			if (match != -1)
+			{
+				int matchEnd = data.indexOf("\r\n", match);
+				if (matchEnd == -1) matchEnd = data.length();
+				ifNoneMatch = data.mid(match + 14, matchEnd - match - 14).trimmed();
+			}
             QString linkStr;
             linkStr.append(data);
 			int end = data.indexOf(" ", begin + 5);
@@ -570,10 +621,7 @@ more:
             tcp->disconnectFromHost();
 			return;
 		}
-		int indexUser = -1;
-		int count = Parent->ConnectionUsers.count();
-		for (int n=0; n<count; n++)
-					if (Parent->ConnectionUsers[n].Name == UserName) indexUser = n;
+		int indexUser = Parent->findUser(UserName);
 			if (indexUser != -1)
 				if (Parent->ConnectionUsers[indexUser].PassWord == PassWord)
 					Privilege = Parent->ConnectionUsers[indexUser].Rigths;
@@ -601,12 +649,9 @@ more:
 	}
 	else if (Privilege == Server::NoRigths)
 	{
-		int indexUser = -1;
-		int count = Parent->ConnectionUsers.count();
 		if (!UserName.isEmpty())
 		{
-			for (int n=0; n<count; n++)
-						if (Parent->ConnectionUsers[n].Name == UserName) indexUser = n;
+			int indexUser = Parent->findUser(UserName);
 				if (indexUser != -1)
 					if (Parent->ConnectionUsers[indexUser].PassWord == PassWord)
 						Privilege = Parent->ConnectionUsers[indexUser].Rigths;
@@ -710,17 +755,25 @@ more:
                 if (tcp->isValid()) tcp->write("<" File_not_found ">");
                 tcp->waitForBytesWritten(10000);
 			}
-			else
+			QString range;
+			if (file.isOpen())
 			{
-				configdata.append(qCompress(file.readAll()));
+				if (order.contains(RangeOffsetStr))
+				{
+					QByteArray data;
+					range = tcpData::readRange(file, order, data);
+					configdata.append(qCompress(data));
+				}
+				else configdata.append(qCompress(file.readAll()));
 				file.close();
 			}
 			QString header;
 			header.append(headerStart"\n");
 			header.append(logisdom::saveformat(DataTypeStr, DataDeviceTypeStr));
 			header.append(logisdom::saveformat(CompressedData, "1"));
+			header.append(range);
 			header.append(logisdom::saveformat(DataSize, QString("%1").arg(configdata.size())));
-			header.append(logisdom::saveformat(RequestStr, order));
+			header.append(logisdom::saveformat(RequestStr, tcpData::removeRange(order)));
 			header.append(headerEnd"\n");
             if (tcp->isValid()) tcp->write(header.toUtf8());
             tcp->waitForBytesWritten(10000);
@@ -834,12 +887,17 @@ more:
 				else
 				{
 					maison1wirewindow->GenMsg("Read : " + filename);
-					if (compress) configdata.append(qCompress(file.readAll()));
-					else configdata.append(file.readAll());
+					QString range;
+					QByteArray data;
+					if (order.contains(RangeOffsetStr)) range = tcpData::readRange(file, order, data);
+					else data = file.readAll();
+					if (compress) configdata.append(qCompress(data));
+					else configdata.append(data);
 					file.close();
 					QString header;
 					header.append(headerStart"\n");
 					header.append(logisdom::saveformat(DataTypeStr, DataFileTypeStr));
+					header.append(range);
 					if (compress) header.append(logisdom::saveformat(CompressedData, "1"));
 					else header.append(logisdom::saveformat(CompressedData, "0"));
 					header.append(logisdom::saveformat(DataSize, QString("%1").arg(configdata.size())));
@@ -24,9 +24,9 @@
 #ifndef CONNECTION_H
 #define CONNECTION_H
 
-class Server;
 #include <QWidget>
 #include <QTcpSocket>
+#include "server.h"
 
 
 class Connection : public QWidget
@@ -68,10 +68,12 @@ private:
 	QString UserName;
 	QString PassWord;
 	QByteArray buffer;
+	QByteArray ifNoneMatch;
 	void writeHeader(QByteArray dataType, bool compressed, long datasize, QByteArray order, QByteArray headerExtraData);
 	void writeToClient(QByteArray data);
 	bool writeWebFile(const QString &Data, const QString &type);
     bool writePng(const QString &Data);
+    void writeCachedResponse(const Server::cachedResponse &response);
 };
 
 #endif
@@ -28,6 +28,7 @@
 #include "onewire.h"
 #include "dataloader.h"
 #include "logisdom.h"
+#include "zipcompactor.h"
 
 
 
@@ -590,6 +591,7 @@ bool dataloader::loadData(int month, int year)
 	}
 	else
 	{
+		QMutexLocker zipLocker(zipcompactor::zipLock(zipFileName));
 		QuaZip zip(zipFileName);
 		if(zip.open(QuaZip::mdUnzip))
 		{
@@ -599,6 +601,9 @@ bool dataloader::loadData(int month, int year)
 			QuaZipFileInfo info;
 			QuaZipFile zipFile(&zip);
 			QString name;
+			QByteArray lastEntry;
+			bool found = false;
+// a month reprocessed after it was zipped is appended again, the last entry replaces the previous ones
 			for(bool more=zip.goToFirstFile(); more; more=zip.goToNextFile())
 			{
 				if (zip.getCurrentFileInfo(&info))
@@ -614,15 +619,8 @@ bool dataloader::loadData(int month, int year)
                             if(zipFile.open(QIODeviceBase::ReadOnly))
 #endif
 							{
-								QBuffer data;
-								data.open(QIODevice::ReadWrite);
-								data.write(zipFile.readAll());
-								data.reset();
-								QTextStream in;
-								//in.setCodec(QTextCodec::codecForLocale());
-								in.setDevice(&data);
-								extractdata(in, offset);
-								dataLoaded = true;
+								lastEntry = zipFile.readAll();
+								found = true;
 								zipFile.close();
 							}
 							else logtxt += ("Zip file open error : " + name);
@@ -630,6 +628,18 @@ bool dataloader::loadData(int month, int year)
 					}
 				}
 			}
+			if (found)
+			{
+				QBuffer data;
+				data.open(QIODevice::ReadWrite);
+				data.write(lastEntry);
+				data.reset();
+				QTextStream in;
+				//in.setCodec(QTextCodec::codecForLocale());
+				in.setDevice(&data);
+				extractdata(in, offset);
+				dataLoaded = true;
+			}
 			zip.close();
 			if(zip.getZipError() != UNZ_OK) logtxt += ("Zip file close error : " + zipFileName);
 		}
@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#include "onewire.h"
+#include "deviceregistry.h"
+
+
+
+void deviceregistry::add(onewiredevice *device)
+{
+    if (!device) return;
+    QMutexLocker locker(&mutex);
+    if (nameOf.contains(device)) return;
+    QString RomID = device->getromid();
+    QString name = device->getname();
+    order.append(device);
+    if (!romids.contains(RomID)) romids.insert(RomID, device);
+    nameOf.insert(device, name);
+    if (!name.isEmpty() && !names.contains(name)) names.insert(name, device);
+    QString key = enoceanKey(RomID);
+    if (!enocean.contains(key)) enocean.insert(key, device);
+    families[RomID.right(2)].append(device);
+    masters[device->getMaster()].append(device);
+}
+
+
+
+
+void deviceregistry::remove(onewiredevice *device)
+{
+    QMutexLocker locker(&mutex);
+    if (!nameOf.contains(device)) return;
+    QString RomID = device->getromid();
+    QString name = nameOf.take(device);
+    order.removeOne(device);
+    if (romids.value(RomID) == device)
+    {
+        romids.remove(RomID);
+        foreach (onewiredevice *other, order)
+            if (other->getromid() == RomID)
+            {
+                romids.insert(RomID, other);
+                break;
+            }
+    }
+    if (names.value(name) == device)
+    {
+        names.remove(name);
+        onewiredevice *other = firstWithName(name);
+        if (other) names.insert(name, other);
+    }
+    QString key = enoceanKey(RomID);
+    if (enocean.value(key) == device)
+    {
+        enocean.remove(key);
+        onewiredevice *other = firstWithEnOceanKey(key);
+        if (other) enocean.insert(key, other);
+    }
+    families[RomID.right(2)].removeOne(device);
+    QHash <net1wire*, QList <onewiredevice*> >::iterator it;
+    for (it = masters.begin(); it != masters.end(); ++it) it.value().removeOne(device);
+}
+
+
+
+
+// Called by the device each time its name is assigned
+void deviceregistry::rename(onewiredevice *device)
+{
+    QMutexLocker locker(&mutex);
+    if (!nameOf.contains(device)) return;
+    QString name = device->getname();
+    QString previous = nameOf.value(device);
+    if (name == previous) return;
+    nameOf.insert(device, name);
+    if (names.value(previous) == device)
+    {
+        names.remove(previous);
+        onewiredevice *other = firstWithName(previous);
+        if (other) names.insert(previous, other);
+    }
+    if (!name.isEmpty())
+    {
+        onewiredevice *other = names.value(name);
+        if (!other || (order.indexOf(device) < order.indexOf(other))) names.insert(name, device);
+    }
+}
+
+
+
+
+bool deviceregistry::contains(onewiredevice *device)
+{
+    QMutexLocker locker(&mutex);
+    return nameOf.contains(device);
+}
+
+
+
+
+onewiredevice *deviceregistry::byRomID(const QString &RomID)
+{
+    QMutexLocker locker(&mutex);
+    return romids.value(RomID, nullptr);
+}
+
+
+
+
+onewiredevice *deviceregistry::byName(const QString &Name)
+{
+    QMutexLocker locker(&mutex);
+    return names.value(Name, nullptr);
+}
+
+
+
+
+onewiredevice *deviceregistry::byEnOceanID(const QString &RomID)
+{
+    QMutexLocker locker(&mutex);
+    return enocean.value(enoceanKey(RomID), nullptr);
+}
+
+
+
+
+QList <onewiredevice*> deviceregistry::byFamily(const QString &family)
+{
+    QMutexLocker locker(&mutex);
+    return families.value(family);
+}
+
+
+
+
+// The master of a device can be cleared when the master is removed
+QList <onewiredevice*> deviceregistry::byMaster(net1wire *master)
+{
+    QMutexLocker locker(&mutex);
+    QList <onewiredevice*> list;
+    foreach (onewiredevice *device, masters.value(master))
+        if (device->getMaster() == master) list.append(device);
+    return list;
+}
+
+
+
+
+// Sender ID and the EEP family : first 10 characters and the last 2,
+// or the last 4 when the RomID ends with a channel suffix like _A
+QString deviceregistry::enoceanKey(const QString &RomID)
+{
+    if (RomID.contains("_")) return RomID.left(10) + RomID.right(4);
+    return RomID.left(10) + RomID.right(2);
+}
+
+
+
+
+onewiredevice *deviceregistry::firstWithName(const QString &Name)
+{
+    foreach (onewiredevice *device, order)
+        if (nameOf.value(device) == Name) return device;
+    return nullptr;
+}
+
+
+
+
+onewiredevice *deviceregistry::firstWithEnOceanKey(const QString &key)
+{
+    foreach (onewiredevice *device, order)
+        if (enoceanKey(device->getromid()) == key) return device;
+    return nullptr;
+}
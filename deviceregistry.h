@@ -0,0 +1,64 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#ifndef DEVICEREGISTRY_H
+#define DEVICEREGISTRY_H
+#include <QtCore>
+
+class onewiredevice;
+class net1wire;
+
+
+// Device lookups by RomID, name, pointer and EnOcean sender ID, with
+// lists by family and by master. The first device added wins when two
+// share a key, as the linear searches did.
+
+class deviceregistry
+{
+public:
+    void add(onewiredevice *device);
+    void remove(onewiredevice *device);
+    void rename(onewiredevice *device);
+    bool contains(onewiredevice *device);
+    onewiredevice *byRomID(const QString &RomID);
+    onewiredevice *byName(const QString &Name);
+    onewiredevice *byEnOceanID(const QString &RomID);
+    QList <onewiredevice*> byFamily(const QString &family);
+    QList <onewiredevice*> byMaster(net1wire *master);
+    static QString enoceanKey(const QString &RomID);
+private:
+    QMutex mutex;
+    QList <onewiredevice*> order;
+    QHash <QString, onewiredevice*> romids;
+    QHash <QString, onewiredevice*> names;
+    QHash <onewiredevice*, QString> nameOf;
+    QHash <QString, onewiredevice*> enocean;
+    QHash <QString, QList <onewiredevice*> > families;
+    QHash <net1wire*, QList <onewiredevice*> > masters;
+    onewiredevice *firstWithName(const QString &Name);
+    onewiredevice *firstWithEnOceanKey(const QString &key);
+};
+
+#endif // DEVICEREGISTRY_H
@@ -610,11 +610,9 @@ void ecogest::removeDuplicates()
 		count = fifoListCount();
 		for (int n=0; n<(count-1); n++)
 		{
-			QListWidgetItem *item = ui.fifolist->item(n);
-			if (item->text().contains(dup))
+			if (fifoListAt(n).contains(dup))
 			{
-				ui.fifolist->takeItem(n);
-				delete item;
+				fifoListRemoveAt(n);
 				found = true;
 				break;
 			}
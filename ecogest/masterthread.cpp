@@ -74,6 +74,8 @@ void masterthread::run()
     endLessLoop = true;
     QElapsedTimer timer;
     timer.start();
+    link.setOwner(this, &log, &endLessLoop);
+    link.setSocket(&MySocket, &tcpStatus);
     QString msg = "Thread starts, first connection";
     TCPconnect(MySocket, msg);
     while (endLessLoop)
@@ -135,55 +137,16 @@ void masterthread::run()
         mutexData.unlock();
         saveLog();
     }
-    MySocket.disconnectFromHost();
-    if (MySocket.state() != QAbstractSocket::UnconnectedState) MySocket.waitForDisconnected();
-    tcpStatus = MySocket.state();
-    emit(tcpStatusChange());
+    link.disconnectLink();
 }
 
 
 
 
 
-void masterthread::TCPconnect(QTcpSocket &Socket, const QString &Status)
+void masterthread::TCPconnect(QTcpSocket &, const QString &Status)
 {
-    log += addTimeTag "TCP Connect  " + Status;
-    int tryConnect = 1;
-    do
-    {
-        log += addTimeTag QString("TCP try connect %1").arg(tryConnect);
-        if (Socket.state() == QAbstractSocket::ConnectedState)
-        {
-            Socket.disconnectFromHost();
-            log += addTimeTag "Try Disconnect";
-            if (Socket.state() == QAbstractSocket::ConnectedState) Socket.waitForDisconnected();
-        }
-        if (Socket.state() == QAbstractSocket::UnconnectedState)
-        {
-            log += addTimeTag "Disconnect OK";
-        }
-        tcpStatus = Socket.state();
-        emit(tcpStatusChange());
-        if (endLessLoop)
-        {
-            Socket.connectToHost(moduleipaddress, port);
-            log += addTimeTag "Try Connect";
-            Socket.waitForConnected();
-            if (Socket.state() == QAbstractSocket::ConnectedState)
-            {
-                log += addTimeTag "Connect OK";
-            }
-            tcpStatus = Socket.state();
-            emit(tcpStatusChange());
-            tryConnect ++;
-        }
-        if (tryConnect > 10)
-        {
-            log.clear();
-            tryConnect = 0;
-        }
-    }
-    while ((Socket.state() != QAbstractSocket::ConnectedState) && (endLessLoop));
+    link.connectLink(moduleipaddress, port, Status);
 }
 
 
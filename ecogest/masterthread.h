@@ -27,6 +27,7 @@
 #include <QtCore>
 #include <QThread>
 #include <QTcpSocket>
+#include "bustransport.h"
 
 class masterthread : public QThread
 {
@@ -80,6 +81,7 @@ public:
 	int fileIndex;
 	QDateTime lastSearch;
 private:
+    bustransport link;
 	void removeDuplicates();
 	QString getStr(int index);
     void TCPconnect(QTcpSocket &Socket, const QString &Status);
@@ -66,8 +66,8 @@ eocean::eocean(logisdom *Parent) : net1wire(Parent)
     connect(&eoThread, SIGNAL(eoStatusChange()), this, SLOT(eoStatusChange()), Qt::QueuedConnection);
     connect(&eoThread, SIGNAL(logThis(QString)), this, SLOT(logThis(QString)), Qt::QueuedConnection);
     connect(&eoThread, SIGNAL(newDevice(QString)), this, SLOT(addNewDevice(QString)), Qt::QueuedConnection);
-    connect(&eoThread, SIGNAL(deviceReturn(QString, QString)), this, SLOT(deviceReturn(QString, QString)), Qt::QueuedConnection);
-    connect(&eoThread, SIGNAL(deviceReturn(QString, QString)), this, SLOT(logReturn(QString, QString)), Qt::QueuedConnection);
+    qRegisterMetaType<eoceanthread::eoTelegram>();
+    connect(&eoThread, SIGNAL(telegram(eoceanthread::eoTelegram)), this, SLOT(telegramReceived(eoceanthread::eoTelegram)), Qt::QueuedConnection);
     connect(&eoThread, SIGNAL(tcpStatusChange()), this, SLOT(tcpStatusChange()), Qt::QueuedConnection);
     type = NetType(EOceanType);
     ui.EditType->setText("EnOcean");
@@ -269,6 +269,51 @@ void eocean::tcpStatusChange()
 
 
 
+quint64 eocean::routeKey(quint32 senderID, quint8 rorg)
+{
+    return (quint64(senderID) << 8) | rorg;
+}
+
+
+
+void eocean::rebuildRoutes()
+{
+// RomID = sender ID (8 hex) + RORG (2 hex) + EEP / family + optional _X suffix
+    routes.clear();
+    for (int n=0; n<localdevice.count(); n++)
+    {
+        onewiredevice *dev = localdevice.at(n);
+        if (!dev) continue;
+        QString RomID = dev->getromid();
+        if (RomID.length() < 10) continue;
+        bool okID, okRorg;
+        quint32 senderID = RomID.left(8).toUInt(&okID, 16);
+        quint8 rorg = quint8(RomID.mid(8, 2).toUInt(&okRorg, 16));
+        if (!okID || !okRorg) continue;
+        routes[routeKey(senderID, rorg)].append(dev);
+    }
+    routesRevision = localDeviceRevision;
+}
+
+
+
+void eocean::telegramReceived(const eoceanthread::eoTelegram &t)
+{
+    QString scratchpad;
+    for (int n=0; n<t.length; n++) scratchpad += QString("%1").arg(t.data[n], 2, 16, QChar('0')).toUpper();
+    if (ui.checkBoxLog->isChecked())
+    {
+        QString RomID = QString("%1").arg(t.senderID, 8, 16, QChar('0')).toUpper() + QString("%1").arg(t.rorg, 2, 16, QChar('0')).toUpper() + familyEOcean;
+        logReturn(RomID, scratchpad);
+    }
+    if (scratchpad.isEmpty()) return;
+    if (routesRevision != localDeviceRevision) rebuildRoutes();
+    QList <onewiredevice*> devices = routes.value(routeKey(t.senderID, t.rorg));
+    foreach (onewiredevice *dev, devices) dev->setscratchpad(scratchpad, dev->isAutoSave());
+}
+
+
+
 void eocean::logReturn(const QString RomID, const QString scratchpad)
 {
     QString log_Str;
@@ -59,7 +59,12 @@ private:
     static void getDeviceList(const QString RomID, QStringList &DevList);
     QStringList LocalCatalog;
     bool upgradeCatalogInfo = false;
+    QHash <quint64, QList <onewiredevice*> > routes;
+    quint64 routesRevision = quint64(-1);
+    void rebuildRoutes();
+    static quint64 routeKey(quint32 senderID, quint8 rorg);
 private slots:
+    void telegramReceived(const eoceanthread::eoTelegram &t);
     void logReturn(const QString, const QString);
     void logThis(const QString);
     void changeComPort(const QString& port);
@@ -90,10 +90,9 @@ void eoceanthread::run()
     timer.start();
     QTcpSocket MySocket;
     socket = &MySocket;
+    link.setOwner(this, nullptr, &endLessLoop);
+    link.setSocket(&MySocket, &tcpStatus);
     //MySocket.moveToThread(this);
-    QSerialPort MySerial;
-    serial = &MySerial;
-    //MySerial.moveToThread(this);
     int sd = MySocket.socketDescriptor();
     int set = 1;
 #ifdef Q_OS_LINUX
@@ -121,13 +120,9 @@ void eoceanthread::run()
     }
     if (useSerial)
     {
-        serial->setPortName(adress);
-        serial->setBaudRate(56700);
-        serial->setDataBits(QSerialPort::Data8);
-        serial->setParity(QSerialPort::NoParity);
-        serial->setStopBits(QSerialPort::OneStop);
-        serial->setFlowControl(QSerialPort::NoFlowControl);
-        if (!serial->open(QIODevice::ReadWrite))
+        bool opened = link.openSerial(adress, 56700);
+        serial = link.serialPort();
+        if (!opened)
         {
             emit(logThis("Failed to open " + adress + " " + serial->errorString()));
             endLessLoop = false;
@@ -307,50 +302,12 @@ void eoceanthread::run()
 
 void eoceanthread::TCPconnect(QString &Status)
 {
-    QElapsedTimer timer;
-    emit(logThis("TCP Connect  to " + adress  + QString(":%1 ").arg(port) + Status));
-    int tryConnect = 1;
-    do
-    {
-        timer.start();
-        emit(logThis(QString("TCP try connect %1").arg(tryConnect)));
-        if (socket->state() == QAbstractSocket::ConnectedState)
-        {
-            socket->disconnectFromHost();
-            emit(logThis("Try Disconnect"));
-            if (socket->state() == QAbstractSocket::ConnectedState) socket->waitForDisconnected();
-            if (socket->state() == QAbstractSocket::UnconnectedState)
-            {
-                emit(logThis("Disconnect OK"));
-            }
-        }
-        tcpStatus = socket->state();
-        emit(tcpStatusChange());
-        if (endLessLoop)
-        {
-            socket->connectToHost(adress, port);
-            emit(logThis("Try Connect"));
-            socket->waitForConnected();
-            if (socket->state() == QAbstractSocket::ConnectedState)
-            {
-                emit(logThis("Connect OK"));
-            }
-            else
-            {
-                emit(logThis("Connection error : " + socket->errorString()));
-                while (timer.elapsed() < 2000);
-                timer.start();
-            }
-            tcpStatus = socket->state();
-            emit(tcpStatusChange());
-            tryConnect ++;
-        }
-        if (tryConnect > 10)
-        {
-            tryConnect = 0;
-        }
-    }
-    while ((socket->state() != QAbstractSocket::ConnectedState) && (endLessLoop));
+// connection steps are collected then sent to the log window in one go
+    QString linkLog;
+    link.setOwner(this, &linkLog, &endLessLoop);
+    link.connectLink(adress, port, "to " + adress + QString(":%1 ").arg(port) + Status);
+    link.setOwner(this, nullptr, &endLessLoop);
+    emit(logThis(linkLog));
 }
 
 
@@ -572,8 +529,6 @@ void eoceanthread::processData(const EOpacket &packet)
     log.append(QString("Process packet type = %1 ").arg(packet.Type));
     log.append(logPacket(packet));
     emit(logThis(log));
-    QString str;
-    QString data_Str;
     uint8_t rorg = packet.data.at(0);
     if (packet.Type == PACKET_RESPONSE) {
         QByteArray data;
@@ -589,17 +544,14 @@ void eoceanthread::processData(const EOpacket &packet)
     {
         case RORG_4BS:
         {   // Process packet type = 1 Data : A5826A840F019FA33430 Opt data : 00FFFFFFFF4100
-            QString s;
-            QString log_Str;
-            device_ID = packet.data.at(5); device_ID <<= 8; device_ID += packet.data.at(6); device_ID <<= 8; device_ID += packet.data.at(7); device_ID <<= 8; device_ID += packet.data.at(8);
-            QString deviceID = QString("%1").arg(quint32(device_ID), 8, 16, QChar('0')).toUpper();
-            //emit(logThis(deviceID));
-            QString deviceRorg = QString("%2").arg(uchar(rorg), 2, 16, QChar('0')).toUpper();
-            //emit(logThis(deviceRorg));
-            for (int n=1; n<5; n++) data_Str += QString("%1").arg(packet.data.at(n), 2, 16, QLatin1Char('0')).toUpper();
-            QString RomIDRorgOnly = deviceID + deviceRorg + familyEOcean;
+            if (packet.data.count() < 10) break;
+            device_ID = readID(packet.data, 5);
+            eoTelegram t;
+            t.senderID = device_ID;
+            t.rorg = rorg;
+            t.length = 4;
+            for (int n=0; n<4; n++) t.data[n] = packet.data.at(n + 1);
 // Process packet type = 1 Data : A532407F08050643CD00 Opt data : 00FFFFFFFF2A0
-            if (deviceRorg == "A5")
             {
                 /*  VALVE POS: Example in HEX "0x05 0x77 0x00 0x08"
                  DB3.7...DB3.0 = 0x05 = 5: new valve position is 5%
@@ -617,6 +569,7 @@ void eoceanthread::processData(const EOpacket &packet)
                 o DB1.2 = 1: DB3.7...DB3.0 is set to internal temp.-controller with default duty cycle (Summer
                 bit not active)
                 DB0.7...DB0.0 = 0x08: Data telegram */
+                QString deviceID = QString("%1").arg(quint32(device_ID), 8, 16, QChar('0')).toUpper();
                 QString RomIDA52001 = deviceID + familyeoA52001;
                 //emit(logThis("Check if exist " + RomIDA52001));
                 int index = deviceRomIDs.indexOf(RomIDA52001);
@@ -644,15 +597,11 @@ void eoceanthread::processData(const EOpacket &packet)
                         response.Optdata.append(0); // packet.Optdata.at(6))
                     }
                     sendESP3(response);
-                    data_Str.clear();
-                    data_Str += QString("%1").arg(response.data.at(1), 2, 16, QLatin1Char('0')).toUpper();
-                    data_Str += QString("%1").arg(packet.data.at(2), 2, 16, QLatin1Char('0')).toUpper();
-                    data_Str += QString("%1").arg(packet.data.at(3), 2, 16, QLatin1Char('0')).toUpper();
-                    data_Str += QString("%1").arg(packet.data.at(4), 2, 16, QLatin1Char('0')).toUpper();
+                    t.data[0] = response.data.at(1);
                 }
                 //else emit(logThis("No value to set for " + RomIDA52001));
             }
-            emit(deviceReturn(RomIDRorgOnly, data_Str));
+            emit(telegram(t));
         } break;
         case RORG_VLD:
         { // D2 046080 05164727 00
@@ -679,13 +628,14 @@ void eoceanthread::processData(const EOpacket &packet)
                 } break;
                 case 0x04 :// D20460E40516472700 Opt data : 00FFFFFFFF4000
                 {
-                    device_ID = packet.data.at(4); device_ID <<= 8; device_ID += packet.data.at(5); device_ID <<= 8; device_ID += packet.data.at(6); device_ID <<= 8; device_ID += packet.data.at(7);
-                    QString deviceID = QString("%1").arg(qint32(device_ID), 8, 16, QChar('0')).toUpper();
-                    QString deviceProfile = QString("%2").arg(uchar(rorg), 2, 16, QChar('0')).toUpper();
-                    QString RomID = deviceID + deviceProfile + familyEOcean;
-                    QString scratchpad;
-                    for (int n=1; n<4; n++) scratchpad += QString("%1").arg(packet.data.at(n), 2, 16, QLatin1Char('0')).toUpper();
-                    emit(deviceReturn(RomID, scratchpad));
+                    if (packet.data.count() < 8) break;
+                    device_ID = readID(packet.data, 4);
+                    eoTelegram t;
+                    t.senderID = device_ID;
+                    t.rorg = rorg;
+                    t.length = 3;
+                    for (int n=0; n<3; n++) t.data[n] = packet.data.at(n + 1);
+                    emit(telegram(t));
                 } break;
                 case 0x05 :
                 {
@@ -724,13 +674,14 @@ void eoceanthread::processData(const EOpacket &packet)
     } break;
         case RORG_RPS:
         {
-            device_ID = packet.data.at(2); device_ID <<= 8; device_ID += packet.data.at(3); device_ID <<= 8; device_ID += packet.data.at(4); device_ID <<= 8; device_ID += packet.data.at(5);
-            QString deviceID = QString("%1").arg(qint32(device_ID), 8, 16, QChar('0')).toUpper();
-            QString deviceProfile = QString("%2").arg(uchar(rorg), 2, 16, QChar('0')).toUpper();
-            QString RomID = deviceID + deviceProfile + familyEOcean;
-            quint8 device_Data = packet.data.at(1);
-            QString scratchpad = QString("%1").arg(uchar(device_Data), 2, 16, QChar('0')).toUpper();
-            emit(deviceReturn(RomID, scratchpad));
+            if (packet.data.count() < 6) break;
+            device_ID = readID(packet.data, 2);
+            eoTelegram t;
+            t.senderID = device_ID;
+            t.rorg = rorg;
+            t.length = 1;
+            t.data[0] = packet.data.at(1);
+            emit(telegram(t));
         } break;
         default:
         {
@@ -741,6 +692,13 @@ void eoceanthread::processData(const EOpacket &packet)
 
 
 
+quint32 eoceanthread::readID(const QVector <uint8_t> &data, int index)
+{
+    return (quint32(data.at(index)) << 24) | (quint32(data.at(index + 1)) << 16) | (quint32(data.at(index + 2)) << 8) | quint32(data.at(index + 3));
+}
+
+
+
 void eoceanthread::saveConfig()
 {
 }
@@ -802,7 +760,7 @@ void eoceanthread::sendESP3(EOpacket &packet)
     }
     if (useSerial)
     {
-        if (serial->isOpen())
+        if (serial && serial->isOpen())
         {
             serial->write(dataSend);
             serial->waitForBytesWritten(1000);
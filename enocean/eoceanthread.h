@@ -27,6 +27,7 @@
 #include <QtCore>
 #include <QThread>
 #include <QTcpSocket>
+#include "bustransport.h"
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QMutex>
@@ -51,6 +52,14 @@ struct EOpacket
     uint8_t Type;
     QVector <uint8_t> data;
     QVector <uint8_t> Optdata;
+};
+// decoded radio telegram, data holds the payload bytes given to the devices
+struct eoTelegram
+{
+    quint32 senderID;
+    quint8 rorg;
+    quint8 length;
+    quint8 data[4];
 };
     eoceanthread();
     ~eoceanthread();
@@ -73,10 +82,11 @@ struct EOpacket
     void addtofifo(const QString &order);
     bool learnMode = false;
 private:
+    bustransport link;
     QList <FIFOStruc*> FIFO;
     uint32_t lastDestinationID;
     QTcpSocket *socket;
-    QSerialPort *serial;
+    QSerialPort *serial = nullptr;
     QString adress;
     int port;
     QByteArray dataBuffer;
@@ -94,15 +104,18 @@ private:
     QString getRomID(uint8_t rorg, uint8_t func, uint8_t type, uint32_t ID);
     QString logPacket(const EOpacket&);
     void appendID(QVector <uint8_t> &data, uint32_t ID);
+    static quint32 readID(const QVector <uint8_t> &data, int index);
     void learnModeOff();
     void TCPconnect(QString &Status);
 signals:
     void newDevice(QString);
-    void deviceReturn(const QString&, const QString&);
+    void telegram(const eoceanthread::eoTelegram&);
     void eoStatusChange();
 	void newStatus();
     void logThis(const QString&);
     void tcpStatusChange();
 };
 
+Q_DECLARE_METATYPE(eoceanthread::eoTelegram)
+
 #endif // EOCEANTHREAD_H
@@ -139,6 +139,14 @@ void errlog::setCfgStr(const QString &strsearch)
 	QString txt = tr("Choose sound");
 	if (!soundPath.isEmpty()) txt += "  ("+ fileInfo.fileName() + ")";
 	ui.pushButtonChoose->setStatusTip(txt);
+// Show the end of the previous session log, read from the end of the file
+	QMutexLocker locker(&logMutex);
+	if (logstate && appendStr.isEmpty())
+	{
+		QStringList lines = logwriter::lastLines(filename, 100);
+		for (int n=lines.count()-1; n>=0; n--) appendStr.append(lines.at(n) + "\n");
+		if (!appendStr.isEmpty()) updateTimer.start(200);
+	}
 }
 
 
@@ -221,11 +229,11 @@ QString errlog::SetError(int ErrID, const QString &Msg)
 	ui.errortext->moveCursor(QTextCursor::End);
 	switch (ErrorLevel)
 	{
-                case LogOnly :		parent->logthis(filename, ErrorMessage, ""); break;
-                case LogAndShow :	parent->logthis(filename, ErrorMessage, "");
+                case LogOnly :		parent->logthis(filename, ErrorMessage, "", logwriter::logWarning); break;
+                case LogAndShow :	parent->logthis(filename, ErrorMessage, "", logwriter::logWarning);
                                         parent->alarmwindow->show();
 					raiseError(); break;
-                case ErrorLogOnly :	parent->logthis(filename, ErrorMessage, ""); break;
+                case ErrorLogOnly :	parent->logthis(filename, ErrorMessage, "", logwriter::logError); break;
                 case ErrorWarn :	parent->alarmwindow->show();
                                         parent->alarmwindow->raise();
 					raiseError(); break;
@@ -270,7 +278,8 @@ void errlog::AddMsg(const QString &Msg)
         //QString currenttext = ui.errortext->toPlainText();
         //if (currenttext.length() > 100000) ui.errortext->setText(currenttext.mid(90000));
         //ui.errortext->moveCursor(QTextCursor::End);
-        updateTimer.start(200);
+        if (QThread::currentThread() == updateTimer.thread()) updateTimer.start(200);
+        else QMetaObject::invokeMethod(&updateTimer, "start", Qt::QueuedConnection, Q_ARG(int, 200));
 }
 
 
@@ -26,6 +26,7 @@
 #include <QtCore>
 #include "commonstring.h"
 #include "logisdom.h"
+#include "configindex.h"
 
 
 #define SecsInDays 86400
@@ -215,26 +216,18 @@
 
 
 #define SearchLoopBegin												\
-int index_a = 0, index_b = 0, index = 0;									\
+int index = 0;													\
 QString strsearch;												\
-index_a = configdata.indexOf("\n" + TAG_Begin, 0);								\
-do															\
+const QStringList configBlocks = configindex::blocks(configdata, TAG_Begin, TAG_End);		\
+for (index = 0; index < configBlocks.count(); index++)								\
     {														\
-    if (index_a != -1)											\
         {													\
-         index_b = configdata.indexOf("\n" + TAG_End, index_a);					\
-         if (index_b != -1)										\
-        {													\
-            strsearch = configdata.mid(index_a, index_b - index_a);
+            strsearch = configBlocks.at(index);
 
 
 #define SearchLoopEnd												\
         }													\
-            }												\
-        index_a = configdata.indexOf("\n" + TAG_Begin, index_b);					\
-        index ++;												\
-        }													\
-    while(index_a != -1);
+    }
 
 
 
@@ -249,6 +249,7 @@ void ha7net::updateLog()
     QString str;
     HttpThread->getLog(str);
     ui.textBrowser->setText(str);
+    foreach (onewiredevice *dev, localdevice) HttpThread->setReadPeriod(dev->getromid().left(16), dev->saveInterval.getSecs());
 }
 
 
@@ -56,19 +56,29 @@ void ha7netthread::run()
 #define addTimeTag "\r" + QDateTime::currentDateTime().toString("HH:mm:ss:zzz  ") +
 	QString Data;
 	QString reqstr;
+	// one manager for the thread life so the HTTP connection is kept alive
+	QNetworkAccessManager Manager;
+	manager = &Manager;
+	scheduleClock.start();
+	lastRateReport = 0;
+	int minute = -1;
     while (endLessLoop)
     {
 // Process FIFOSpecial
-        if (logEnabled)
+        if (!FIFOSpecial.isEmpty())
         {
-            log += addTimeTag "********************     FIFOSpecial contains   *************************************";
-            for (int n=0; n<FIFOSpecial.count(); n++) log += addTimeTag "" + FIFOSpecial.at(n)->Request;
-            log += addTimeTag "*************************************************************************************";
-                            processFIFOSpecial();
+            if (logEnabled)
+            {
+                log += addTimeTag "********************     FIFOSpecial contains   *************************************";
+                for (int n=0; n<FIFOSpecial.count(); n++) log += addTimeTag "" + FIFOSpecial.at(n)->Request;
+                log += addTimeTag "*************************************************************************************";
+            }
+            processFIFOSpecial();
         }
-// Search sequence
-        if (FIFO.isEmpty())
+// Search sequence, checked once a minute
+        if (minute != QDateTime::currentDateTime().time().minute())
         {
+            minute = QDateTime::currentDateTime().time().minute();
             bool search = true;
             if (lastSearch.isValid())
             {
@@ -102,56 +112,32 @@ void ha7netthread::run()
                 for (int n=0; n<devices.count(); n++) log += addTimeTag "" + QString ("Device_%1 RomID : ").arg(n) + devices.at(n)->RomID + "   Original Scratchpad : " + devices.at(n)->Scratchpad;
                 log += addTimeTag "*************************************************************************************";
             }
-// Fill FIFO with device readings
-            if (FIFO.isEmpty())	// if FIFO is empty add all request otherwise, finish las bunch
-            {
-                if (logEnabled) log += addTimeTag "********************    Fill FIFO with device Reading  *******************************";
-                addDeviceReadings();
-            }
+            reportReadRates();
         }
-// Log FIFO content
+// Queue conversions and readings that are due
+        scheduleReadings();
         if (logEnabled) for (int n=0; n<FIFO.count(); n++) log += addTimeTag "" + FIFO.at(n)->RomID + " : " + FIFO.at(n)->Request + QString ("   Scratchpad_ID : %1").arg(FIFO.at(n)->scratchpad_ID);
-        if (logEnabled) log += addTimeTag "**************************************************************************************";
-// Get device reading info
+        bool busy = !FIFO.isEmpty();
         processFIFO();
-        saveLog();
-        int minute = QDateTime::currentDateTime().time().minute();
-        while ((minute == QDateTime::currentDateTime().time().minute()) && endLessLoop)
-        {
-            if (!FIFOSpecial.isEmpty())
-            {
-                processFIFOSpecial();
-            }
-            if (FIFO.isEmpty())
-            {
-                if (logEnabled) log += addTimeTag "***************    Fill FIFO with device Reading for reading till next minute  *********************";
-                addDeviceReadings(false);
-                if (logEnabled)
-                {
-                    for (int n=0; n<FIFO.count(); n++) log += addTimeTag "" + FIFO.at(n)->RomID + " : " + FIFO.at(n)->Request + QString ("   Scratchpad_ID : %1").arg(FIFO.at(n)->scratchpad_ID);
-                    log += addTimeTag "**************************************************************************************";
-                }
-            }
-            processFIFO(false);
-            saveLog();
-            sleep(1);
-        }
-        // Clear FIFO
-        mutexData.lock();
-        while (!FIFO.isEmpty())
-        {
-            delete FIFO.first();
-            FIFO.removeFirst();
-        }
-        mutexData.unlock();
-        saveLog();
+        if (busy) saveLog();
+        if (FIFO.isEmpty() && FIFOSpecial.isEmpty()) msleep(100);
     }
+    // Clear FIFO
+    mutexData.lock();
+    while (!FIFO.isEmpty())
+    {
+        delete FIFO.first();
+        FIFO.removeFirst();
+    }
+    mutexData.unlock();
+    saveLog();
+    manager = nullptr;
 }
 
 
 
 
-void ha7netthread::processFIFO(bool ALL)
+void ha7netthread::processFIFO()
 {
 	QString Data;
 	while (!FIFO.isEmpty() && FIFOSpecial.isEmpty() && endLessLoop)
@@ -159,14 +145,13 @@ void ha7netthread::processFIFO(bool ALL)
         if (logEnabled) log += addTimeTag "------------------------------------------------------------------------------";
 		QString Req = FIFO.first()->Request;
 		get(Req, Data);
+		if (FIFO.first()->batched) conversionStarted(FIFO.first());
 		readFIFOBuffer(Data);
-		msleep(250);
 		mutexData.lock();
 		//logThis("processFIFO : " + Req);
 		delete FIFO.first();
 		FIFO.removeFirst();
 		mutexData.unlock();
-		if (!ALL) return;
 	}
 }
 
@@ -199,6 +184,7 @@ void ha7netthread::saveLog()
     {
         log += addTimeTag "*******************************    Device Scratchpad  **********************************";
         for (int n=0; n<devices.count(); n++) log += addTimeTag "" + devices.at(n)->RomID + "  Scratchpad : " + devices.at(n)->Scratchpad;
+        if (latencyCount) log += addTimeTag QString("Http requests : %1  average latency : %2 ms  max : %3 ms").arg(latencyCount).arg(latencyTotal / latencyCount).arg(latencyMax);
         log += addTimeTag "_________________________________FIN__________________________________\r\r";
         QString filename = moduleipaddress;
         filename.remove(".");
@@ -218,6 +204,22 @@ void ha7netthread::saveLog()
 
 
 
+ha7netthread::device *ha7netthread::createDevice(const QString &RomID)
+{
+	device *dev = new device;
+	dev->RomID = RomID;
+	dev->SearchLevel = 0;
+	dev->isValid = true;
+	dev->savePeriod = 0;
+	dev->nextRead = 0;
+	dev->convertDone = -1;
+	dev->readCount = 0;
+	return dev;
+}
+
+
+
+
 int ha7netthread::checkDevice(const QString RomID)
 {
 	bool found = false;
@@ -232,8 +234,7 @@ int ha7netthread::checkDevice(const QString RomID)
 	}
 	if (!found)
 	{
-		device *dev = new device;
-		dev->RomID = RomID;
+		device *dev = createDevice(RomID);
 		ID = devices.count();
         if (logEnabled) log += addTimeTag " Found new device : " + RomID + QString("  Index %1").arg(ID);
 		devices.append(dev);
@@ -266,8 +267,7 @@ QByteArray strsearch;
 			}
 			if (!found)
 			{
-				device *dev = new device;
-				dev->RomID = RomID;
+				device *dev = createDevice(RomID);
 				devices.append(dev);
                 emit(newDevice(devices.last()->RomID));
 			}
@@ -303,15 +303,33 @@ void ha7netthread::get(QString &Request, QString &Data)
 	}
     else if (logEnabled) log += addTimeTag " Http error " + http.errorString() ;*/
 
-    QNetworkAccessManager manager;
+    Data.clear();
+    if (!manager) return;
     QString reqstr = "http://" + moduleipaddress + QString(":%1").arg(port) + "/1Wire/" + Request;
     if (logEnabled) log += addTimeTag " SEND : " + reqstr;
     logThis(QDateTime::currentDateTime().toString("HH:mm:ss:zzz  ") + "SEND : " + reqstr);
-    QNetworkReply *reply = manager.get(QNetworkRequest(QUrl(reqstr)));
+    QNetworkRequest request(QUrl(reqstr));
+    request.setRawHeader("Connection", "Keep-Alive");
+    QElapsedTimer latency;
+    latency.start();
+    QNetworkReply *reply = manager->get(request);
     QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
     QObject::connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+    QObject::connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
+    timeout.start(httpTimeout);
     loop.exec();
-    Data.clear();
+    if (!reply->isFinished())
+    {
+        if (logEnabled) log += addTimeTag "Http timeout";
+        reply->abort();
+    }
+    qint64 elapsed = latency.elapsed();
+    latencyTotal += elapsed;
+    latencyCount ++;
+    if (elapsed > latencyMax) latencyMax = elapsed;
+    if (logEnabled) log += addTimeTag QString("Http latency %1 ms").arg(elapsed);
     if (reply->error() == QNetworkReply::NoError)
     {
         QByteArray data = reply->readAll();
@@ -325,6 +343,7 @@ void ha7netthread::get(QString &Request, QString &Data)
         if (logEnabled) log += addTimeTag " GET : " + Data;
     }
     else if (logEnabled) log += addTimeTag "Http error " + reply->errorString();
+    reply->deleteLater();
 }
 
 
@@ -341,9 +360,11 @@ void ha7netthread::readFIFOBuffer(const QString &htmlData)
 	switch (FIFO.first()->Request_ID)
 	{
 		case ConvertTemp	:
+					if (FIFO.first()->batched) break;
                     if (logEnabled) log += addTimeTag QString(" Wait for convesion : 1 second");
 					sleep(1); break;
 		case ConvertTempRomID	:
+					if (FIFO.first()->batched) break;
 					if ((deviceIndex >= 0) && (deviceIndex < devices.count())) {
 					int convTime = getConvertTime(devices.at(deviceIndex));
                     if (logEnabled) log += addTimeTag QString(" Wait for convesion : %1ms").arg(convTime);
@@ -426,83 +447,196 @@ int ha7netthread::getConvertTime(device *dev)
 
 
 
-void ha7netthread::addDeviceReadings(bool ALL)
+// the interface gives the device save interval, readings are never
+// further apart than maxReadPeriod so the values stay fresh on screen
+void ha7netthread::setReadPeriod(const QString &RomID, qint64 secs)
 {
-	QString reqstr;
-	if (GlobalConvert)
-	{
-		if (LockID.isEmpty()) reqstr = "Reset.html";
-		else reqstr = "Reset.html?" + LockID;
-		FIFOAppend(Reset, reqstr);
-		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Data=CC44";
-		else reqstr = "WriteBlock.html?" + LockID + "&Data=CC44";
-		FIFOAppend(ConvertTemp, reqstr);
-	}
-	for(int index=0; index<devices.count(); index++)
+	QMutexLocker locker(&mutexData);
+	for (int n=0; n<devices.count(); n++)
+		if (devices.at(n)->RomID == RomID) devices.at(n)->savePeriod = secs * 1000;
+}
+
+
+
+
+qint64 ha7netthread::readPeriod(device *dev)
+{
+	QString family = dev->RomID.right(2);
+	bool timed = getConvertTime(dev) || (family == family2423);
+	if (!timed) return switchReadPeriod;
+	if ((dev->savePeriod <= 0) || (dev->savePeriod > maxReadPeriod)) return maxReadPeriod;
+	return dev->savePeriod;
+}
+
+
+
+
+// every device has its own deadline, conversions are started ahead of it
+// so the result is ready when the deadline comes, and first deadlines are
+// spread over the period so the bus load is even
+void ha7netthread::scheduleReadings()
+{
+	qint64 now = scheduleClock.elapsed();
+	if (GlobalConvert && (globalConvertDone < 0))
 	{
-		QString RomID = devices.at(index)->RomID;
-		QString family = RomID.right(2);
-		if (!GlobalConvert)
-		{
-			if (getConvertTime(devices.at(index)))
-			{
-				if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=44";
-				else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=44";
-				FIFOAppend(ConvertTempRomID, reqstr, index);
-			}
-		}
-		if ((family == family1822) || (family == family1820)  || (family == family18B20))
+		bool due = false;
+		for (int index=0; index<devices.count(); index++)
+			if (getConvertTime(devices.at(index)) && (devices.at(index)->nextRead - 1000 <= now)) due = true;
+		if (due)
 		{
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=BEFFFFFFFFFFFFFFFFFF";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=BEFFFFFFFFFFFFFFFFFF";
-			FIFOAppend(ReadTemp, reqstr, index);
+			QString reqstr;
+			if (LockID.isEmpty()) reqstr = "Reset.html";
+			else reqstr = "Reset.html?" + LockID;
+			FIFOAppend(Reset, reqstr);
+			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Data=CC44";
+			else reqstr = "WriteBlock.html?" + LockID + "&Data=CC44";
+			FIFOAppend(ConvertTemp, reqstr);
+			FIFO.last()->batched = true;
+			globalConvertDone = now + 60000;	// set when the convert is sent
 		}
-		else if (family == family2408)
+	}
+	bool globalReady = (globalConvertDone >= 0) && (now >= globalConvertDone);
+	for (int index=0; index<devices.count(); index++)
+	{
+		device *dev = devices.at(index);
+		qint64 period = readPeriod(dev);
+		int convTime = getConvertTime(dev);
+		bool read = false;
+		if (convTime && GlobalConvert)
 		{
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=F08800FFFFFFFFFFFFFFFFFFFF";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=F08800FFFFFFFFFFFFFFFFFFFF";
-			FIFOAppend(ReadPIO, reqstr, index);
+			read = globalReady && (dev->nextRead - 1000 <= now);
 		}
-        else if (isFamily2413)
+		else if (convTime)
 		{
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=F5FF";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=F5FF";
-			FIFOAppend(ReadDualSwitch, reqstr, index);
+			if ((dev->convertDone < 0) && (dev->nextRead - convTime <= now))
+			{
+				addConversion(index);
+				dev->convertDone = now + 60000;	// set when the convert is sent
+			}
+			else if ((dev->convertDone >= 0) && (now >= dev->convertDone)) read = true;
 		}
-		else if ((family == family2423) && ALL)
-		{
+		else read = (dev->nextRead <= now);
+		if (!read) continue;
+		addDeviceRead(index);
+		dev->convertDone = -1;
+		dev->readCount ++;
+		if (dev->nextRead == 0) dev->nextRead = now + period - (index * period / devices.count());
+		else dev->nextRead += period;
+		if (dev->nextRead < now) dev->nextRead = now + period;
+	}
+	if (globalReady) globalConvertDone = -1;
+}
+
+
+
+
+void ha7netthread::conversionStarted(FIFOStruc *request)
+{
+	qint64 now = scheduleClock.elapsed();
+	if (request->Request_ID == ConvertTemp) globalConvertDone = now + 1000;
+	else if ((request->device_ID >= 0) && (request->device_ID < devices.count()))
+	{
+		device *dev = devices.at(request->device_ID);
+		dev->convertDone = now + getConvertTime(dev) + 50;
+	}
+}
+
+
+
+
+void ha7netthread::reportReadRates()
+{
+	qint64 now = scheduleClock.elapsed();
+	qint64 elapsed = now - lastRateReport;
+	lastRateReport = now;
+	if ((elapsed <= 0) || devices.isEmpty()) return;
+	double achieved = 0, target = 0;
+	for (int n=0; n<devices.count(); n++)
+	{
+		device *dev = devices.at(n);
+		double rate = dev->readCount * 60000.0 / elapsed;
+		double goal = 60000.0 / readPeriod(dev);
+		achieved += rate;
+		target += goal;
+		if (logEnabled) log += addTimeTag dev->RomID + QString("  reads/min : %1  target : %2").arg(rate, 0, 'f', 1).arg(goal, 0, 'f', 1);
+		dev->readCount = 0;
+	}
+	logThis(QDateTime::currentDateTime().toString("HH:mm:ss:zzz  ") + QString("Reads/min : %1  target : %2").arg(achieved, 0, 'f', 1).arg(target, 0, 'f', 1));
+}
 
-			if (LockID.isEmpty())
-		       {
-				       reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=A5DF01FFFFFFFFFFFFFFFFFFFFFF";
-				       FIFOAppend(ReadCounter, reqstr, index);
-				       reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=A5FF01FFFFFFFFFFFFFFFFFFFFFF";
-				       FIFOAppend(ReadCounter, reqstr, index, 1);
-		       }
-		       else
-		       {
-				       reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=A5DF01FFFFFFFFFFFFFFFFFFFFFF";
-				       FIFOAppend(ReadCounter, reqstr, index);
-				       reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=A5FF01FFFFFFFFFFFFFFFFFFFFFF";
-				       FIFOAppend(ReadCounter, reqstr, index, 1);
-		       }
-		}
-		else if (family == family2438)
-		{
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=44";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=44";
-			FIFOAppend(ConvertTempRomID, reqstr, index);
 
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=B4";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=B4";
-			FIFOAppend(ConvertV, reqstr, index);
 
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=B800";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=B800";
-			FIFOAppend(RecallMemPage00h, reqstr, index);
 
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=BE00FFFFFFFFFFFFFFFFFF";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=BE00FFFFFFFFFFFFFFFFFF";
+void ha7netthread::addConversion(int index)
+{
+	QString reqstr;
+	QString RomID = devices.at(index)->RomID;
+	if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=44";
+	else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=44";
+	FIFOAppend(ConvertTempRomID, reqstr, index);
+	FIFO.last()->batched = true;
+}
+
+
+
+
+void ha7netthread::addDeviceRead(int index)
+{
+	QString reqstr;
+	QString RomID = devices.at(index)->RomID;
+	QString family = RomID.right(2);
+	if ((family == family1822) || (family == family1820)  || (family == family18B20))
+	{
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=BEFFFFFFFFFFFFFFFFFF";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=BEFFFFFFFFFFFFFFFFFF";
+		FIFOAppend(ReadTemp, reqstr, index);
+	}
+	else if (family == family2408)
+	{
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=F08800FFFFFFFFFFFFFFFFFFFF";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=F08800FFFFFFFFFFFFFFFFFFFF";
+		FIFOAppend(ReadPIO, reqstr, index);
+	}
+	else if (isFamily2413)
+	{
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=F5FF";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=F5FF";
+		FIFOAppend(ReadDualSwitch, reqstr, index);
+	}
+	else if (family == family2423)
+	{
+
+		if (LockID.isEmpty())
+	       {
+			       reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=A5DF01FFFFFFFFFFFFFFFFFFFFFF";
+			       FIFOAppend(ReadCounter, reqstr, index);
+			       reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=A5FF01FFFFFFFFFFFFFFFFFFFFFF";
+			       FIFOAppend(ReadCounter, reqstr, index, 1);
+	       }
+	       else
+	       {
+			       reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=A5DF01FFFFFFFFFFFFFFFFFFFFFF";
+			       FIFOAppend(ReadCounter, reqstr, index);
+			       reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=A5FF01FFFFFFFFFFFFFFFFFFFFFF";
+			       FIFOAppend(ReadCounter, reqstr, index, 1);
+	       }
+	}
+	else if (family == family2438)
+	{
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=44";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=44";
+		FIFOAppend(ConvertTempRomID, reqstr, index);
+
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=B4";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=B4";
+		FIFOAppend(ConvertV, reqstr, index);
+
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=B800";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=B800";
+		FIFOAppend(RecallMemPage00h, reqstr, index);
+
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=BE00FFFFFFFFFFFFFFFFFF";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=BE00FFFFFFFFFFFFFFFFFF";
             FIFOAppend(ReadPage00h, reqstr, index);
 
             if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=B801";
@@ -513,16 +647,15 @@ void ha7netthread::addDeviceReadings(bool ALL)
             else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=BE01FFFFFFFFFFFFFFFFFF";
             FIFOAppend(ReadPage01h, reqstr, index);
         }
-		else if (family == family2450)
-		{
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=3C0F00FFFF";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=3C0F00FFFF";
-			FIFOAppend(ConvertADC, reqstr, index);
+	else if (family == family2450)
+	{
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=3C0F00FFFF";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=3C0F00FFFF";
+		FIFOAppend(ConvertADC, reqstr, index);
 
-			if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=AA0000FFFFFFFFFFFFFFFFFFFF";
-			else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=AA0000FFFFFFFFFFFFFFFFFFFF";
-			FIFOAppend(ReadADC, reqstr, index);
-		}
+		if (LockID.isEmpty()) reqstr = "WriteBlock.html?Address=" + RomID.left(16) + "&Data=AA0000FFFFFFFFFFFFFFFFFFFF";
+		else reqstr = "WriteBlock.html?" + LockID + "&Address=" + RomID.left(16) + "&Data=AA0000FFFFFFFFFFFFFFFFFFFF";
+		FIFOAppend(ReadADC, reqstr, index);
 	}
 }
 
@@ -606,6 +739,7 @@ void ha7netthread::addToFIFOSpecial(const QString &data)
 	newFIFO->Request = data;
 	newFIFO->scratchpad_ID = -1;
 	newFIFO->device_ID = -1;
+	newFIFO->batched = false;
 	mutexData.lock();
 	FIFOSpecial.append(newFIFO);
 	logThis("FIFOSpecialAppend : " + data);
@@ -624,6 +758,7 @@ void ha7netthread::FIFOAppend(int reqID, const QString &reqStr, int device_ID, i
 	newFIFO->scratchpad_ID = scratchpad_ID;
 	if ((device_ID >= 0) && (device_ID < devices.count())) newFIFO->RomID = devices.at(device_ID)->RomID; else newFIFO->RomID = "";
 	newFIFO->device_ID = device_ID;
+	newFIFO->batched = false;
 	FIFO.append(newFIFO);
 	mutexData.unlock();
 }
@@ -660,6 +795,7 @@ void ha7netthread::FIFOSpecialAppend(int reqID, const QString &reqStr, int devic
 	newFIFO->scratchpad_ID = scratchpad_ID;
 	if ((device_ID >= 0) && (device_ID < devices.count())) newFIFO->RomID = devices.at(device_ID)->RomID; else newFIFO->RomID = "";
 	newFIFO->device_ID = device_ID;
+	newFIFO->batched = false;
 	FIFOSpecial.append(newFIFO);
 	logThis("FIFOSpecialAppend : " + reqStr);
 	mutexData.unlock();
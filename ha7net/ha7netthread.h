@@ -26,6 +26,8 @@
 
 #include <QtCore>
 #include <QThread>
+#include <QNetworkAccessManager>
+#include <QElapsedTimer>
 
 class ha7netthread : public QThread
 {
@@ -39,6 +41,10 @@ struct device
 	QString Return;
 	int SearchLevel;
 	bool isValid;
+	qint64 savePeriod;
+	qint64 nextRead;
+	qint64 convertDone;
+	int readCount;
 };
 private:
 struct FIFOStruc
@@ -48,7 +54,11 @@ struct FIFOStruc
 	int Request_ID;
 	int device_ID;
 	int scratchpad_ID;
+	bool batched;
 };
+#define httpTimeout 10000
+#define maxReadPeriod 60000
+#define switchReadPeriod 5000
 public:
 	ha7netthread();
 	~ha7netthread();
@@ -68,22 +78,36 @@ public:
 	QDateTime lastSearch;
 	void addToFIFOSpecial(const QString &RomID, const QString &data, int Request_ID = 0);
 	void addToFIFOSpecial(const QString &data);
+	void setReadPeriod(const QString &RomID, qint64 secs);
 	QList <device*> devices;
 private:
 	QString LockID;
+	QNetworkAccessManager *manager = nullptr;
+	qint64 latencyTotal = 0;
+	qint64 latencyMax = 0;
+	int latencyCount = 0;
+	QElapsedTimer scheduleClock;
+	qint64 globalConvertDone = -1;
+	qint64 lastRateReport = 0;
+	device *createDevice(const QString &RomID);
+	qint64 readPeriod(device *dev);
+	void scheduleReadings();
+	void conversionStarted(FIFOStruc *request);
+	void reportReadRates();
+	void addConversion(int index);
+	void addDeviceRead(int index);
 	void logThis(const QString &str);
 	void SearchAnalysis(const QString &data);
 	int checkDevice(const QString RomID);
 	void get(QString &Request, QString &Data);
 	void FIFOAppend(int reqID, const QString &reqStr, int device_ID = -1, int scratchpad_ID = 0);
 	void FIFOSpecialAppend(int reqID, const QString &reqStr, int device_ID, int scratchpad_ID = 0);
-	void addDeviceReadings(bool ALL = true);
 	QList <FIFOStruc*> FIFO;
 	QList <FIFOStruc*> FIFOSpecial;
 	int getConvertTime(device *dev);
 	void readFIFOBuffer(const QString &htmlData);
 	void readFIFOSpecialBuffer(const QString &htmlData);
-	void processFIFO(bool ALL = true);
+	void processFIFO();
 	void processFIFOSpecial();
 	void saveLog();
 signals:
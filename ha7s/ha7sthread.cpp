@@ -75,6 +75,9 @@ void ha7sthread::run()
 	QDateTime tourneRead, lastTourneRead;
 	tourneRead = QDateTime::currentDateTime();
 	lastTourneRead = tourneRead;
+    link.setOwner(this, &log, &endLessLoop);
+    link.setSocket(&MySocket, &tcpStatus);
+    link.setTerminator("\r");
     QString msg = "Thread starts, first connection";
     TCPconnect(MySocket, msg);
     while (endLessLoop)
@@ -126,10 +129,7 @@ void ha7sthread::run()
         }
         saveLog();
     }
-    MySocket.disconnectFromHost();
-    if (MySocket.state() != QAbstractSocket::UnconnectedState) MySocket.waitForDisconnected();
-    tcpStatus = MySocket.state();
-    emit(tcpStatusChange());
+    link.disconnectLink();
     isRunning = false;
 }
 
@@ -164,45 +164,9 @@ int ha7sthread::checkDevice(const QString RomID)
 
 
 
-void ha7sthread::TCPconnect(QTcpSocket &Socket, QString &Status)
+void ha7sthread::TCPconnect(QTcpSocket &, QString &Status)
 {
-    log += addTimeTag "TCP Connect  " + Status;
-	int tryConnect = 1;
-	do
-	{
-        log += addTimeTag QString("TCP try connect %1").arg(tryConnect);
-		if (Socket.state() == QAbstractSocket::ConnectedState)
-		{
-			Socket.disconnectFromHost();
-            log += addTimeTag "Try Disconnect";
-            if (Socket.state() == QAbstractSocket::ConnectedState) Socket.waitForDisconnected();
-		}
-		if (Socket.state() == QAbstractSocket::UnconnectedState)
-		{
-            log += addTimeTag "Disconnect OK";
-		}
-		tcpStatus = Socket.state();
-		emit(tcpStatusChange());
-        if (endLessLoop)
-        {
-            Socket.connectToHost(moduleipaddress, port);
-            log += addTimeTag "Try Connect";
-            Socket.waitForConnected();
-            if (Socket.state() == QAbstractSocket::ConnectedState)
-            {
-                log += addTimeTag "Connect OK";
-            }
-            tcpStatus = Socket.state();
-            emit(tcpStatusChange());
-            tryConnect ++;
-        }
-        if (tryConnect > 10)
-        {
-            log.clear();
-            tryConnect = 0;
-        }
-    }
-    while ((Socket.state() != QAbstractSocket::ConnectedState) && (endLessLoop));
+    link.connectLink(moduleipaddress, port, Status);
 }
 
 
@@ -213,42 +177,33 @@ void ha7sthread::get(QTcpSocket &Socket, QString &Request, QString &Data)
 	Request += "\r";
 	Data.clear();
     log += addTimeTag " SEND : " + Request;
-	if (Socket.state() == QAbstractSocket::ConnectedState)
-	{
-        if (Socket.isValid()) Socket.write(Request.toLatin1()); else return;
-        if (Socket.waitForBytesWritten())
-		{
-            QThread::msleep(200);
-			if (Socket.waitForReadyRead())
-			{
-                Data.append(Socket.readAll());
-                log += addTimeTag " GET : " + Data;
-				int retry = 0;
-				while ((!Data.endsWith(CR)) && (retry < 5))
-				{
-                    log += addTimeTag " DATA not complete wait more : " + Data;
-					if (Socket.waitForReadyRead(1000)) Data.append(Socket.readAll());
-					retry ++;
-				}
-				if (Data.endsWith(CR)) Data.chop(1);
-                else log += addTimeTag " DATA not complete, abort : " + Data;
-			}
-			else
-			{
-				QString msg = "Socket error , reconnect, request = " + Request;
-				TCPconnect(Socket, msg);
-			}
-		}
-		else
-		{
+    QByteArray answer;
+// Answer ends with CR, the adapter may need up to 30s for a conversion
+    switch (link.request(Request.toLatin1(), answer, 30000, 1000))
+    {
+        case bustransport::requestDone :
+            Data = QString::fromLatin1(answer);
+            log += addTimeTag " GET : " + Data;
+            Data.chop(1);
+            break;
+        case bustransport::requestPartial :
+            Data = QString::fromLatin1(answer);
+            log += addTimeTag " DATA not complete, abort : " + Data;
+            break;
+        case bustransport::requestWriteError :
             log += addTimeTag "Error writing data : " + Request;
-		}
-	}
-	else
-	{
-		QString msg = "Socket error before writing, reconnect, request = " + Request;
-		TCPconnect(Socket, msg);
-	}
+            break;
+        case bustransport::requestTimeout :
+        {
+            QString msg = "Socket error , reconnect, request = " + Request;
+            TCPconnect(Socket, msg);
+        } break;
+        default :
+        {
+            QString msg = "Socket error before writing, reconnect, request = " + Request;
+            TCPconnect(Socket, msg);
+        } break;
+    }
 }
 
 
@@ -390,6 +345,7 @@ void ha7sthread::saveLog()
     {
         log += addTimeTag "*******************************    Device Scratchpad  **********************************";
         for (int n=0; n<devices.count(); n++) log += addTimeTag "" + devices.at(n)->RomID + "  Scratchpad : " + devices.at(n)->Scratchpad;
+        log += addTimeTag link.statistics();
         log += addTimeTag "_________________________________FIN__________________________________\r\r";
         QString filename = moduleipaddress;
         filename.remove(".");
@@ -27,6 +27,7 @@
 #include <QtCore>
 #include <QThread>
 #include <QTcpSocket>
+#include "bustransport.h"
 
 
 class ha7sthread : public QThread
@@ -74,6 +75,7 @@ public:
 	int fileIndex;
 	QDateTime lastSearch;
 private:
+	bustransport link;
 	int checkDevice(const QString RomID);
 	void get(QTcpSocket &Socket, QString &Request, QString &Data);
 	void TCPconnect(QTcpSocket &Socket, QString &Status);
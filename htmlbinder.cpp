@@ -41,6 +41,7 @@ htmlBinder::htmlBinder(logisdom *Parent, QTreeWidgetItem *ParentItem)
 	htmlMenuList.setSortingEnabled(true);
 	//setParameter("ID", ID); for debug only
     connect(&htmlMenuList, SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(clickHtmlList(QListWidgetItem*)));
+    connect(&htmlMenuList, SIGNAL(itemChanged(QListWidgetItem*)), this, SLOT(htmlMenuChanged(QListWidgetItem*)));
 }
 
 
@@ -56,6 +57,7 @@ htmlBinder::htmlBinder(logisdom *Parent, QString MainMenu, QTreeWidgetItem *Pare
 	widgetSetup();
 	//setParameter("ID", ID); for debug only
     connect(&htmlMenuList, SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(clickHtmlList(QListWidgetItem*)));
+    connect(&htmlMenuList, SIGNAL(itemChanged(QListWidgetItem*)), this, SLOT(htmlMenuChanged(QListWidgetItem*)));
 }
 
 
@@ -95,6 +97,7 @@ void htmlBinder::setHtmlMenulist(QListWidget *List)
 		}
 	}
 	htmlMenuList.sortItems();
+	parent->htmlBinderRevision++;
 	/*for (int n=0; n<htmlMenuList.count(); n++)
 		if (htmlMenuList.item(n)->checkState()) backup.append(htmlMenuList.item(n)->text());
 	htmlMenuList.clear();
@@ -122,6 +125,7 @@ void htmlBinder::removeHtmlMenulist(QString name)
 		}
 	}
 	htmlMenuList.sortItems();
+	parent->htmlBinderRevision++;
 }
 
 
@@ -137,6 +141,23 @@ void htmlBinder::clickHtmlList(QListWidgetItem *item)
 
 
 
+void htmlBinder::htmlMenuChanged(QListWidgetItem*)
+{
+// menu membership of this binder has changed, other menus must be rebuilt
+	parent->htmlBinderRevision++;
+}
+
+
+
+
+void htmlBinder::setHtmlDirty()
+{
+	htmlDirty = true;
+}
+
+
+
+
 void htmlBinder::emitSendConfigStr(const QString &command)
 {
 	//GenMsg("Binder emit  " + ID + "  " + command);
@@ -194,10 +215,12 @@ QTreeWidgetItem *htmlBinder::setParameter(const QString &Name, const QString &Tx
 	if (!item)
 	{
 		item = new QTreeWidgetItem(treeItem, 1);
+		setHtmlDirty();
 	}
 	//item->setIcon(0, folderIcon);
     if ((lastName != Name) || (lastTxt != Txt))
     {
+        setHtmlDirty();
         item->setText(0, Name);
         item->setText(1, Txt);
         lastName = Name;
@@ -251,6 +274,7 @@ void htmlBinder::setCfgStr(QString &str)
 		}
 		newHtmlMenu = logisdom::getvalue(QString("HtmlMenu%1").arg(index++), str);
 	}
+	parent->htmlBinderRevision++;
 }
 
 
@@ -261,6 +285,8 @@ void htmlBinder::setMainParameter(const QString &name, const QString &Txt)
 {
 	treeItem->setText(0, name);
 	treeItem->setText(1, Txt);
+	setHtmlDirty();
+	parent->htmlBinderRevision++;
 }
 
 
@@ -291,47 +317,82 @@ QString htmlBinder::getMainHtml(QString &Request, QString &WebID, int Privilege)
 QString htmlBinder::getChildHtml(QString &Request, QString &WebID, int Privilege, bool displayChilds)
 {
 	QString request = logisdom::getvalue(CRequest, Request);
-	QString link, str, z;
+	QString str, z;
+	QString mark = webIdMark;
 	if (Privilege == Server::FullControl) emit(remoteCommand(request));
-	link =  CRequest "=(" showChilds ")" CUId "=(" + WebID + ")" CMenuId "=(" + ID + ")";
-	str += logisdom::toHtml(treeItem->text(0), link, logisdom::htmlStyleDetector);
-	str += "&nbsp;&nbsp;";
-	str += logisdom::spanIt(treeItem->text(1), logisdom::htmlStyleValue);
-	str += "&nbsp;";
-	str += logisdom::spanIt(getHtmlCommand(treeItem, WebID, Privilege), logisdom::htmlStyleCommand);
-	str += "<br>";
+	int p = (Privilege == Server::FullControl) ? 1 : 0;
+	if (htmlDirty)
+	{
+		selfHtml[0].clear();
+		selfHtml[1].clear();
+		childItemHtml[0].clear();
+		childItemHtml[1].clear();
+		structureRevision = parent->htmlBinderRevision - 1;
+		htmlDirty = false;
+	}
+	if (selfHtml[p].isEmpty())
+	{
+		QString link =  CRequest "=(" showChilds ")" CUId "=(" + mark + ")" CMenuId "=(" + ID + ")";
+		selfHtml[p] += logisdom::toHtml(treeItem->text(0), link, logisdom::htmlStyleDetector);
+		selfHtml[p] += "&nbsp;&nbsp;";
+		selfHtml[p] += logisdom::spanIt(treeItem->text(1), logisdom::htmlStyleValue);
+		selfHtml[p] += "&nbsp;";
+		selfHtml[p] += logisdom::spanIt(getHtmlCommand(treeItem, mark, Privilege), logisdom::htmlStyleCommand);
+		selfHtml[p] += "<br>";
+	}
+	str += selfHtml[p];
 	if (!request.isEmpty())
 	{
 		if (displayChilds)
 		{
-			for (int n=0; n<treeItem->childCount(); n++)
+			if (structureRevision != parent->htmlBinderRevision) updateStructure();
+			if (childItemHtml[p].count() != childBinders.count())
 			{
-				htmlBinder *binder = parent->getTreeItemBinder(treeItem->child(n));
-				if (binder)
+				childItemHtml[p].clear();
+				for (int n=0; n<childBinders.count(); n++)
 				{
-					str.append(binder->getChildHtml(request, WebID, Privilege));
-				}
-				else
-				{
-					QString s = getItemHtml(treeItem->child(n), z, WebID, Privilege);
-					if (!s.isEmpty())
+					QString s;
+					if (!childBinders.at(n))
 					{
-						str.append(s);
-						str.append("<br>");
+						s = getItemHtml(treeItem->child(n), z, mark, Privilege);
+						if (!s.isEmpty()) s.append("<br>");
 					}
+					childItemHtml[p].append(s);
 				}
 			}
-			for (int n=0; n<parent->htmlBinderList.count(); n++)
-				if (parent->htmlBinderList[n]->menuCheck(treeItem->text(0)))
-					str.append(parent->htmlBinderList[n]->getChildHtml(request, WebID, Privilege));
+			for (int n=0; n<childBinders.count(); n++)
+			{
+				if (childBinders.at(n)) str.append(childBinders.at(n)->getChildHtml(request, mark, Privilege));
+				else str.append(childItemHtml[p].at(n));
+			}
+			for (int n=0; n<menuBinders.count(); n++)
+				str.append(menuBinders.at(n)->getChildHtml(request, mark, Privilege));
 		}
 	}
+	str.replace(mark, WebID);
 	return str;
 }
 
 
 
 
+void htmlBinder::updateStructure()
+{
+	childBinders.clear();
+	menuBinders.clear();
+	childItemHtml[0].clear();
+	childItemHtml[1].clear();
+	for (int n=0; n<treeItem->childCount(); n++)
+		childBinders.append(parent->getTreeItemBinder(treeItem->child(n)));
+	for (int n=0; n<parent->htmlBinderList.count(); n++)
+		if (parent->htmlBinderList[n]->menuCheck(treeItem->text(0)))
+			menuBinders.append(parent->htmlBinderList[n]);
+	structureRevision = parent->htmlBinderRevision;
+}
+
+
+
+
 
 
 QString htmlBinder::getItemHtml(QTreeWidgetItem *item, QString&, QString &WebID, int Privilege)
@@ -363,6 +424,8 @@ QString htmlBinder::getItemHtml(QTreeWidgetItem *item, QString&, QString &WebID,
 void htmlBinder::setName(const QString &Name)
 {
 	if (treeItem) treeItem->setText(0, Name);
+	setHtmlDirty();
+	parent->htmlBinderRevision++;
 }
 
 
@@ -375,6 +438,7 @@ void htmlBinder::setValue(const QString &value)
         {
             treeItem->setText(1, value);
             lastValue = value;
+            setHtmlDirty();
             emit(valueChanged());
         }
 }
@@ -385,6 +449,7 @@ void htmlBinder::setValue(const QString &value)
 void htmlBinder::clearCommand()
 {
 	if (treeItem) treeItem->setText(2, "");
+	setHtmlDirty();
 }
 
 
@@ -393,6 +458,7 @@ void htmlBinder::clearCommand()
 
 void htmlBinder::addCommand(QString display, QString html, QTreeWidgetItem *item)
 {
+	setHtmlDirty();
 	if (!item)
 	{
 		if (!treeItem) return;
@@ -454,6 +520,7 @@ QString htmlBinder::getHtmlCommand(QTreeWidgetItem *item, QString &WebID, int Pr
 
 void htmlBinder::addParameterCommand(QString ParameterName, QString display, QString html)
 {
+	setHtmlDirty();
     QTreeWidgetItem *item = nullptr;
 	for (int n=0; n<treeItem->childCount(); n++)
 	{
@@ -495,6 +562,7 @@ void htmlBinder::addParameterCommand(QString ParameterName, QString display, QSt
 
 void htmlBinder::delParameterCommand(QString ParameterName, QString display)
 {
+	setHtmlDirty();
     QTreeWidgetItem * item = nullptr;
     for (int n=0; n<treeItem->childCount(); n++)
     {
@@ -525,6 +593,7 @@ void htmlBinder::delParameterCommand(QString ParameterName, QString display)
 
 void htmlBinder::setParameterLink(QString ParameterName, QString html)
 {
+	setHtmlDirty();
 	QTreeWidgetItem * item = nullptr;
 	for (int n=0; n<treeItem->childCount(); n++)
 	{
@@ -546,6 +615,7 @@ void htmlBinder::setParameterLink(QString ParameterName, QString html)
 
 void htmlBinder::removeParameter(QString ParameterName)
 {
+	setHtmlDirty();
 	QTreeWidgetItem * item = nullptr;
 	for (int n=0; n<treeItem->childCount(); n++)
 	{
@@ -38,6 +38,7 @@ class htmlBinder : public QWidget
 	Q_OBJECT
 #define showChilds "details"
 #define customMenu "custom"
+#define webIdMark "\x1f"
 public:
 	htmlBinder(logisdom *Parent, QTreeWidgetItem *ParentItem = nullptr);
 	htmlBinder(logisdom *Parent, QString MainMenu, QTreeWidgetItem *ParentItem = nullptr);
@@ -73,8 +74,19 @@ public:
 	void removeHtmlMenulist(QString name);
 	void getCfgStr(QString &str);
 	void setCfgStr(QString &str);
+	void setHtmlDirty();
+private:
+// rendered fragments with webIdMark in place of the WebID, one per privilege
+	bool htmlDirty = true;
+	quint64 structureRevision = 0;
+	QString selfHtml[2];
+	QStringList childItemHtml[2];
+	QList <htmlBinder*> childBinders;
+	QList <htmlBinder*> menuBinders;
+	void updateStructure();
 private slots:
 	void clickHtmlList(QListWidgetItem *item);
+	void htmlMenuChanged(QListWidgetItem*);
 signals:
     void remoteCommand(QString);
 	void sendConfigStr(QString);
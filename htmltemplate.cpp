@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+#include "logisdom.h"
+#include "htmltemplate.h"
+
+
+
+htmlTemplate::htmlTemplate()
+{
+    pageLength = 0;
+    fileSize = -1;
+}
+
+
+
+
+htmlTemplate::htmlTemplate(const QString &page)
+{
+    fileSize = -1;
+    compile(page);
+}
+
+
+
+
+void htmlTemplate::compile(const QString &page)
+{
+    segments.clear();
+    pageLength = page.length();
+    int index = 0;
+    while (index < page.length())
+    {
+        int ouv = page.indexOf("[[", index);
+        if (ouv == -1) break;
+        int ferm = page.indexOf("]]", ouv + 2);
+        if (ferm == -1) break;
+        // keep the closest opening in case of "[[ text [[tag]]"
+        int inner = page.lastIndexOf("[[", ferm - 1);
+        if (inner > ouv) ouv = inner;
+        appendLiteral(page.mid(index, ouv - index));
+        segment tag;
+        tag.text = page.mid(ouv + 2, ferm - ouv - 2);
+        if (tag.text.contains(htmlsperarator)) tag.type = TreeTag;
+        else tag.type = DeviceTag;
+        segments.append(tag);
+        index = ferm + 2;
+    }
+    appendLiteral(page.mid(index));
+}
+
+
+
+
+void htmlTemplate::appendLiteral(const QString &txt)
+{
+    int index = 0;
+    while (index < txt.length())
+    {
+        int webid = txt.indexOf("webid=(", index);
+        segment literal;
+        literal.type = Literal;
+        if (webid == -1)
+        {
+            literal.text = txt.mid(index);
+            segments.append(literal);
+            return;
+        }
+        literal.text = txt.mid(index, webid + 7 - index);
+        segments.append(literal);
+        segment id;
+        id.type = WebId;
+        segments.append(id);
+        index = webid + 7;
+    }
+}
@@ -0,0 +1,52 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+#ifndef HTMLTEMPLATE_H
+#define HTMLTEMPLATE_H
+#include <QtCore>
+
+
+// Page text split once into literal parts and [[...]] / webid=( slots
+// so translation is a single concatenation instead of a replace per device
+
+class htmlTemplate
+{
+public:
+enum segmentType { Literal, DeviceTag, TreeTag, WebId };
+struct segment
+{
+    int type;
+    QString text;
+};
+    htmlTemplate();
+    htmlTemplate(const QString &page);
+    void compile(const QString &page);
+    QList <segment> segments;
+    int pageLength;
+    QDateTime lastModified;
+    qint64 fileSize;
+private:
+    void appendLiteral(const QString &txt);
+};
+
+#endif
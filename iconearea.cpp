@@ -50,6 +50,7 @@ IconeArea::IconeArea(logisdom *Parent)
     captureUndo = false;
     htmlEnabled = false;
     undoIndex = -1;
+    revision = 0;
     setMinimumSize(MainMinXSize, MainMinYSize);
     setAcceptDrops(true);
     locked = false;
@@ -132,12 +133,24 @@ void IconeArea::setValue(onewiredevice *device)
     RomID = device->getromid();
 	for (int index=0; index<IconList.count(); index++)
 	{
-        if (IconList.at(index)->romid == RomID) IconList.at(index)->setvalue(device);
+        if (IconList.at(index)->romid == RomID)
+        {
+            QString state = iconState(IconList.at(index));
+            IconList.at(index)->setvalue(device);
+            if (state != iconState(IconList.at(index))) revision++;
+        }
 	}
 }
 
 
 
+QString IconeArea::iconState(iconf *icon)
+{
+    return icon->value->text() + icon->text->text() + icon->actualFileName.text() + icon->CurentValueStyleleHex;
+}
+
+
+
 void IconeArea::AddTextZone()
 {
     icont *text = newText(this);
@@ -154,7 +167,9 @@ void IconeArea::setValue()
         onewiredevice *device = parent->configwin->DeviceExist(IconList.at(index)->romid);
         // line remove 19-11-2023
         //if (IconList.at(index)->highlighted or IconList.at(index)->Thighlighted or IconList.at(index)->Vhighlighted) return;
+        QString state = iconState(IconList.at(index));
         if (device) IconList.at(index)->setvalue(device); else IconList.at(index)->setvalue();
+        if (state != iconState(IconList.at(index))) revision++;
     }
 }
 
@@ -1413,6 +1428,7 @@ void IconeArea::iconAddOne()
 
 void IconeArea::PushUndo()
 {
+	revision++;
 	if (undoIndex != -1) while (undoIndex < (undo.count()-1)) undo.removeLast();
 	QString str;
     for (int index=0; index<IconList.count(); index++) IconList.at(index)->getConfigStr(str);
@@ -97,7 +97,9 @@ public:
     QString getBackGroundColor();
     void setBackGroundColor(QColor);
     void VoirCapteur(QString romID);
+    quint64 revision;
 private:
+    QString iconState(iconf *icon);
 	bool locked;
     bool htmlEnabled;
 	int resize_Icon;
@@ -26,6 +26,7 @@
 #include "logisdom.h"
 #include "onewire.h"
 #include "interval.h"
+#include "scheduler.h"
 
 
 
@@ -33,6 +34,7 @@ interval::interval()
 {
 // palette setup icon
 	enabled = true;
+    scheduleId = scheduler::instance().add(this);
 	setLayout(&setupLayout);
 	setupLayout.addWidget(&SaveEnable);
     nextOne.setDateTime(QDateTime::currentDateTime().addDays(1)); // avoid saving before nextOne is setup by setConfig
@@ -51,6 +53,7 @@ interval::interval()
 	SaveEnable.setCheckState(Qt::Checked);
     connect(&Type, SIGNAL(currentIndexChanged(int)), this, SLOT(stateChanged()));
     connect(&nextOne, SIGNAL(dateTimeChanged(QDateTime)), this, SLOT(stateChanged()));
+    updateSchedule();
 }
 
 
@@ -59,6 +62,7 @@ interval::interval()
 
 interval::~interval()
 {
+    scheduler::instance().remove(scheduleId);
 }
 
 
@@ -71,12 +75,20 @@ void interval::setName(QString name)
 
 
 
+void interval::setKey(const QString &key)
+{
+    scheduler::instance().setKey(scheduleId, key);
+}
+
+
+
 void interval::setEnabled(bool state)
 {
 	enabled = state;
 	SaveEnable.setEnabled(state);
 	Type.setEnabled(state);
 	nextOne.setEnabled(state);
+    updateSchedule();
 }
 
 
@@ -96,6 +108,7 @@ void interval::changeEnable(int state)
 			break;
 	}
     enabled = state;
+    updateSchedule();
     //qDebug() << "emit(readChanged()";
     emit(readChanged());
 }
@@ -103,11 +116,34 @@ void interval::changeEnable(int state)
 
 void interval::stateChanged()
 {
+    updateSchedule();
     //qDebug() << "emit(readChanged()";
     emit(readChanged());
 }
 
 
+
+// The deadline lives in the scheduler, the widget only shows and edits it
+void interval::updateSchedule()
+{
+    int index = Type.currentIndex();
+    int months = 0;
+    qint64 period = 0;
+    if (index == MT) months = 1;
+    else if (index == AUTO) { if (yearEnable) months = 12; }
+    else period = getSecs(nextOne.dateTime());
+    bool active = enabled && SaveEnable.isChecked() && ((period != 0) || (months != 0));
+    scheduler::instance().setEntry(scheduleId, nextOne.dateTime(), period, months, active);
+}
+
+
+
+void interval::scheduled(const QDateTime &next)
+{
+    if (nextOne.dateTime() != next) nextOne.setDateTime(next);
+}
+
+
 qint64 interval::getSecs(const QDateTime &T)
 {
 	int index = Type.currentIndex();
@@ -148,6 +184,7 @@ void interval::enableYear()
     if (yearEnable) return;
     yearEnable = true;
     Type.setItemText(AUTO, tr("One Year"));
+    updateSchedule();
 }
 
 
@@ -180,36 +217,13 @@ bool interval::checkOnly()
 {
     if (!enabled) return false;
     if (!SaveEnable.isChecked()) return false;
-    QDateTime now = QDateTime::currentDateTime();
-    QDateTime next = nextOne.dateTime();
-    qint64 n = getSecs(next);
-    if (n == 0) return false;
-    qint64 gap = next.secsTo(now);
-    if (gap >= 0) return true;
-    return false;
+    return scheduler::instance().isPending(scheduleId);
 }
 
 
 bool interval::isitnow()
 {
-    if (!enabled) return false;
-	if (!SaveEnable.isChecked()) return false;
-    QDateTime now = QDateTime::currentDateTime();
-	QDateTime next = nextOne.dateTime();
-    qint64 n = getSecs(next);
-	if (n == 0) return false;
-    qint64 gap = next.secsTo(now);
-    if (gap >= 0)
-	{
-        do
-		{ next = next.addSecs(n); } 
-			while (next.secsTo(now) >= 0);
-		int s = next.time().second();		// remove seconds
-		if (s != 0) nextOne.setDateTime(next.addSecs(-s));
-			else nextOne.setDateTime(next);
-		return true;
-	}
-    return false;
+    return scheduler::instance().take(scheduleId);
 }
 
 
@@ -218,7 +232,7 @@ bool interval::isitnow()
 
 QString interval::getNext()
 {
-	return nextOne.dateTime().toString(Qt::ISODate);
+	return scheduler::instance().next(scheduleId).toString(Qt::ISODate);
 }
 
 
@@ -53,6 +53,7 @@ public:
     qint64 getSecs();
     void setNext(const QDateTime &T);
 	QString getNext();
+    void setKey(const QString &key);
 	void setMode(int index);
 	QString getMode();
 	void setSaveMode(bool state);
@@ -61,8 +62,11 @@ public:
 private slots:
 	void changeEnable(int state);
     void stateChanged();
+    void scheduled(const QDateTime &next);
 private:
     bool yearEnable = false;
+    int scheduleId;
+    void updateSchedule();
 signals:
     void readChanged();
 };
@@ -71,6 +71,7 @@
 
 
 bool logisdom::NoHex = false;
+volatile sig_atomic_t logisdom::terminateRequest = 0;
 
 #if QT_VERSION < 0x060000
     #define openModeWrite QIODevice::WriteOnly
@@ -97,7 +98,7 @@ logisdom::logisdom(QWidget *parent) : QMainWindow(parent)
     paletteOnTop = false;
     previousSetup = nullptr;
     logfilesizemax = 100000;
-    indexupdate = 0;
+    logger.open();
     lastminute = -1;
     iconFileCheck = false;
     saveInterval = -1;
@@ -712,6 +713,37 @@ void logisdom::removeWidget(QWidget *widget)
 
 
 
+qint64 logisdom::getTabRevision(const QString &name)
+{
+// only icon areas can tell when their content has changed, graphs are always grabbed again
+// tabs can be moved, the area is taken from the tab widget and not from IconeAreaList
+    for (int i=0; i<ui.tabWidgetIcon->count(); i++)
+        if (ui.tabWidgetIcon->tabText(i) == name)
+        {
+            QScrollArea *scroll = qobject_cast<QScrollArea*>(ui.tabWidgetIcon->widget(i));
+            IconeArea *area = scroll ? qobject_cast<IconeArea*>(scroll->widget()) : nullptr;
+            if (area) return qint64(area->revision);
+        }
+    return -1;
+}
+
+
+
+
+// cache key of a tab picture, it changes with the html resize settings and the tab size
+QString logisdom::getTabPixKey(const QString &name)
+{
+    QString key = "tab:" + name;
+    QWidget *current = ui.tabWidgetIcon->currentWidget();
+    if (current) key += QString(":%1x%2").arg(current->width()).arg(current->height());
+    if (configwin && configwin->ui.checkBoxHtmlSize->isChecked())
+        key += QString(":%1:%2").arg(configwin->ui.comboBoxHtmlSize->currentIndex()).arg(configwin->ui.spinBoxHtmlSize->value());
+    return key;
+}
+
+
+
+
 bool logisdom::getTabPix(const QString &name, QBuffer &buffer)
 {
     QMutexLocker locker(&MutexgetTabPix);
@@ -820,65 +852,20 @@ bool logisdom::getTabPix(const QString &name, QBuffer &buffer)
 
 
 
-void logisdom::logthis(const QString &filename, const QString &log, QString S)
+void logisdom::logthis(const QString &filename, const QString &log, QString S, int level)
 {
-	QMutexLocker locker(&mutexLog);
-	QDir localdirectory = QDir("");
-	if (!localdirectory.exists(repertoirelog))
-		if (!localdirectory.mkdir(repertoirelog))
-		{
-                        messageBox::criticalHide(this, "log directory","Impossible to create log directory", this);
-			return;
-		}
-	QDateTime now = QDateTime::currentDateTime();
-	// Create new empty file
-	QString dotnewfilename = QString(repertoirelog) + QDir::separator() + filename + ".new";
-	QString dotlogfilename = QString(repertoirelog) + QDir::separator() + filename + ".log";
-	QFile dotnewfile(dotnewfilename);
-	QFile dotlogfile(dotlogfilename);
-	// creat log file if not exists
-	if (!dotlogfile.exists())
-	{
-		if (dotlogfile.open(QIODevice::WriteOnly | QIODevice::Text))
-		{
-			QTextStream go(&dotlogfile);
-			go << now.toString() << " " << filename << ".log file created " << "\n";
-			dotlogfile.close();
-		}
-	}
-	// if can open write log text
-	if (dotnewfile.open(QIODevice::WriteOnly | QIODevice::Text))
-	{
-		QTextStream out(&dotnewfile);
-		if (S.isEmpty()) out << now.toString("dddd dd/MM/yyyy HH:mm:ss:zzz : ->  ") << log << "\n";
-		else out << now.toString() << " ->  " << log << " '" << S << "'" << "\n";
-		// append previous log content
-		if (dotlogfile.open(QIODevice::ReadOnly | QIODevice::Text))
-		{
-			out << (dotlogfile.readAll());
-			dotlogfile.close();
-		}
-		else
-		{
-            //messageBox::criticalHide(this, "Open file", "Impossible to open file " + dotlogfilename, this);
-			return;
-		}
-		// if file oversize, truncate it
-		dotnewfile.close();
-		if (configwin)
-		{
-			logfilesizemax = configwin->ui.spinBoxLogSize->value() * 1000;
-			if (dotnewfile.size() > logfilesizemax) dotnewfile.resize(logfilesizemax);
-		}
-		// echange files names delete the .log and rename the.new
-		dotlogfile.remove();
-		dotnewfile.rename(dotlogfilename);
-	}
-	else
-	{
-        //messageBox::criticalHide(this,  "Open file", "Impossible to open file " + dotnewfilename, this);
-        return;
-	}
+    logger.append(filename, log, S, level);
+}
+
+
+
+
+
+// Called from the GUI thread when the settings are loaded or changed
+void logisdom::setLogSettings(qint64 maxSize, int minSeverity)
+{
+    logger.setMaxSize(maxSize);
+    logger.setMinSeverity(minSeverity);
 }
 
 
@@ -977,6 +964,8 @@ QTreeWidgetItem *logisdom::addHtmlBinder(htmlBinder *binder)
 	}
 	htmlBinderList.append(binder);
 	treeItemList.append(item);
+	treeItemBinder.insert(item, binder);
+	htmlBinderRevision++;
 	binder->ID = binderID.createUuid().toString().remove("\{").remove("}");
     //qDebug() << QString("%1").arg(htmlBinderList.count());
 	return item;
@@ -989,9 +978,7 @@ QTreeWidgetItem *logisdom::addHtmlBinder(htmlBinder *binder)
 
 htmlBinder *logisdom::getTreeItemBinder(QTreeWidgetItem *item)
 {
-	int n = treeItemList.indexOf(item);
-	if (n != -1) return htmlBinderList[n];
-	return nullptr;
+	return treeItemBinder.value(item, nullptr);
 }
 
 
@@ -1096,8 +1083,10 @@ void logisdom::init(char *argv[])
 		int c = QCoreApplication::arguments().count();
         for (int n=1; n<c; n++)
         {
+#ifndef LOGISDOM_HEADLESS
             if (QCoreApplication::arguments().at(n) ==  "diag")
             if (QMessageBox::question(this, tr("Diag mode"), tr("Enter in startup diag mode ?"), tr("&Non"), tr("&Oui"), QString(), 1, 0)) diag = true;
+#endif
             if (QCoreApplication::arguments().at(n) ==  "remy") remydev = true;
             if (QCoreApplication::arguments().at(n) ==  "log") logTag = true;
             //QList<QByteArray> codecList = QTextCodec::availableCodecs();
@@ -1191,6 +1180,15 @@ void logisdom::init(char *argv[])
 	connect(&workspaceY, SIGNAL(valueChanged(int)), this, SLOT(workSpaceResizeChanged(int)));
 
 	connect(&timerUpdate, SIGNAL(timeout()), this, SLOT(update()));
+// convert -> read -> virtual devices -> heating, the other stages are independent
+    updatePipeline.setDependency(updatepipeline::stageConvert, updatepipeline::stageEvents);
+    updatePipeline.setDependency(updatepipeline::stageRead, updatepipeline::stageConvert);
+    updatePipeline.setDependency(updatepipeline::stageVirtual, updatepipeline::stageRead);
+    updatePipeline.setDependency(updatepipeline::stageHeating, updatepipeline::stageVirtual);
+    updatePipeline.setDependency(updatepipeline::stageTableau, updatepipeline::stageVirtual);
+    updatePipeline.setWorker(updatepipeline::stageNextSave, true);
+    connect(&updatePipeline, SIGNAL(execute(int)), this, SLOT(runUpdateStage(int)), Qt::DirectConnection);
+    connect(&updatePipeline, SIGNAL(finished()), this, SLOT(updateFinished()));
 
     ChauffageArea = new ChauffageScrollArea(this);
     ui.scrollAreaHeating->setWidget(ChauffageArea);
@@ -1389,6 +1387,23 @@ void logisdom::closeEvent(QCloseEvent *event)
 
 
 
+// Same as leaving from the main window without the questions, used by the headless build on SIGTERM
+void logisdom::shutdown()
+{
+    if (!isRemoteMode()) tableauConfig->savePreload();
+    if (!isRemoteMode()) configwin->setNextSave();
+    if (configwin->ui.checkBoxSaveQuit->isChecked()) saveconfig(configfilename);
+    logfile(tr("Close Connections"));
+    configwin->closeNet1Wire();
+    logfile(tr("End ofsession"));
+    QCoreApplication::exit(0);
+}
+
+
+
+
+
+
 void logisdom::restart()
 {
         if (messageBox::questionHide(this, tr("Confirm Restart ?"), tr("Do you really want to restart LogisDom ?"), this, QMessageBox::No | QMessageBox::Yes) == QMessageBox::Yes)
@@ -3030,27 +3045,22 @@ void logisdom::saveconfig(QString fileName)
 		}
 		file.close();
 	}
+// Keep config of devices not created in this session
+	QSet <QString> existing;
+	for (int n=0; n<configwin->devicePtArray.count(); n++) existing.insert(configwin->devicePtArray[n]->getromid());
 	QStringList devRomID, devConfig;
 	QString ReadRomID;
 	QString TAG_Begin = One_Wire_Device;
 	QString TAG_End = EndMark;
 	SearchLoopBegin
 		ReadRomID = getvalue("RomID", strsearch);
-		if ((!ReadRomID.isEmpty()) && (devRomID.indexOf(ReadRomID) == -1))
+		if ((!ReadRomID.isEmpty()) && (!existing.contains(ReadRomID)))
 		{
+			existing.insert(ReadRomID);
 			devRomID.append(ReadRomID);
 			devConfig.append(strsearch);
 		}
 	SearchLoopEnd
-	for (int n=0; n<configwin->devicePtArray.count(); n++)
-	{
-		int found = devRomID.indexOf(configwin->devicePtArray[n]->getromid());
-		if (found != -1)
-		{
-			devRomID.removeAt(found);
-			devConfig.removeAt(found);
-		}
-	}
 // Rename file with .bak_xxx extension
 	QFile renFile(fileName);
 	if (renFile.exists())
@@ -3432,123 +3442,129 @@ void logisdom::showTabWidget(int)
 
 void logisdom::update(bool force)
 {
+#ifdef LOGISDOM_HEADLESS
+    if (terminateRequest)
+    {
+        shutdown();
+        return;
+    }
+#endif
 	if (configwin->isUploading()) return;
 	timerUpdate.stop();
 	QDateTime now = QDateTime::currentDateTime();
-    if (lastminute != now.time().minute() || force)
+    if (!updatePipeline.isRunning())
 	{
-		switch (indexupdate)
+        if (lastminute != now.time().minute() || force)
+        {
+            lastminute = now.time().minute();
+            updatePipeline.start();
+        }
+        else
+        {
+            if (configwin) configwin->generatePng();
+#ifndef LOGISDOM_HEADLESS
+            if (graphconfigwin)
+            {
+                if (configwin->ui.GraphixBox->isChecked())
+                    graphconfigwin->updateGraphs();
+            }
+#endif
+        }
+	}
+	timerUpdate.start(1000);
+	if (configwin->ui.checkBoxkSaveInterval->isChecked())
+	{
+		saveInterval ++;
+		if ((saveInterval/60) >= configwin->ui.spinBoxSaveInterval->value())
 		{
-			case 0 :
-                GenMsg(QString("checkTimeMatch"));
-                ProgEventArea->checkTimeMatch();
-				indexupdate ++;
-				break;
-			case 1 :
-                GenMsg(QString("trier"));
-                ProgEventArea->trier();
-                GenMsg(QString("Convert"));
-                configwin->convert();
-				indexupdate ++;
-				break;
-			case 2 :
-                if (configwin->ui.LectureRecBox->isChecked()) {
-				GenMsg(QString("LectureRecAll"));
+			saveInterval = 0;
+			saveconfig(configfilename);
+		}
+	}
+}
+
+
+
+
+// Called by updatePipeline, ZipFile and NextSave stages run in a pool thread
+void logisdom::runUpdateStage(int stage)
+{
+    switch (stage)
+    {
+        case updatepipeline::stageEvents :
+            GenMsg(QString("checkTimeMatch"));
+            ProgEventArea->checkTimeMatch();
+            GenMsg(QString("trier"));
+            ProgEventArea->trier();
+            break;
+        case updatepipeline::stageConvert :
+            GenMsg(QString("Convert"));
+            configwin->convert();
+            break;
+        case updatepipeline::stageRead :
+            if (configwin->ui.LectureRecBox->isChecked()) {
+                GenMsg(QString("LectureRecAll"));
                 configwin->LectureRecAll(); }
-                indexupdate ++;
-				break;
-			case 3 :
+            break;
+        case updatepipeline::stageIcons :
             if (configwin->ui.IconBox->isChecked()) {
                 GenMsg(QString("IconeAreaList"));
                 for (int n=0; n<IconeAreaList.count(); n++)
-				{
-					IconeAreaList.at(n)->setValue();
-					iconFileCheck = false;
-					if (iconFileCheck) IconeAreaList.at(n)->checkFile(iconFileCheck);
+                {
+                    IconeAreaList.at(n)->setValue();
+                    iconFileCheck = false;
+                    if (iconFileCheck) IconeAreaList.at(n)->checkFile(iconFileCheck);
                 } }
-				indexupdate ++;
-				break;
-			case 4 :
+            break;
+        case updatepipeline::stageMeteo :
             if (configwin->ui.MeteoBox->isChecked()) {
                 GenMsg(QString("Meteo"));
                 MeteoArea->timerupdate(); }
-				indexupdate ++;
-				break;
-			case 5 :
+            break;
+        case updatepipeline::stageHeating :
             if (configwin->ui.Chauffagebox->isChecked()) {
                 GenMsg(QString("ChauffageArea->process()"));
                 ChauffageArea->process(); }
-				indexupdate ++;
-				break;
-			case 6 :
+            break;
+        case updatepipeline::stageVirtual :
             if (configwin->ui.VirtualDeviceBox->isChecked()) {
                 GenMsg(QString("configwin->LectureRecVD()"));
                 configwin->LectureRecVD(); }
-				indexupdate ++;
-				break;
-			case 7 :
+            break;
+        case updatepipeline::stageSendAll :
             if (configwin->ui.SendAllBox->isChecked()) {
                 GenMsg(QString("configwin->server->sendAll()"));
                 configwin->server->sendAll(); }
-				indexupdate ++;
-				break;
-			case 8 :
-				//GenMsg(QString("graphconfigwin->updateGraphs()"));
-				//if (graphconfigwin) graphconfigwin->updateGraphs();
-                if (graphconfigwin) graphconfigwin->raz_counter();
-				indexupdate ++;
-				break;
-			case 9 :
+            break;
+        case updatepipeline::stageGraph :
+            if (graphconfigwin) graphconfigwin->raz_counter();
+            break;
+        case updatepipeline::stageTableau :
             if (configwin->ui.SaveTableauBox->isChecked()) {
                 GenMsg(QString("tableauConfig->saveTableau()"));
                 if (tableauConfig) tableauConfig->saveTableau(); }
-				indexupdate ++;
-				break;
-			case 10 :
+            break;
+        case updatepipeline::stageZip :
+// GUI thread : the device list is changed by NewDevice and removeVD, the compaction itself runs in zipCompactor
             if (configwin->ui.ZipFileBox->isChecked()) {
                 GenMsg(QString("checkDatZipFile"));
                 configwin->checkDatZipFile(); }
-				indexupdate ++;
-				break;
-			case 11 :
+            break;
+        case updatepipeline::stageNextSave :
             if (configwin->ui.NextSaveBox->isChecked()) {
                 GenMsg(QString("saveNextSave"));
                 configwin->setNextSave(); }
-				indexupdate ++;
-				break;
-			case 12 :
-				indexupdate ++;
-				break;
-			case 13 :
-			default :
-				lastminute = now.time().minute();
-                GenMsg(QString("Update finished"));
-				indexupdate = 0;
-                mainStatus();
-				break;
-		}
-		timerUpdate.start(200);
-		QCoreApplication::processEvents(QEventLoop::AllEvents);
-	}
-    else
-	{
-		if (configwin) configwin->generatePng();
-        if (graphconfigwin)
-        {
-            if (configwin->ui.GraphixBox->isChecked())
-                graphconfigwin->updateGraphs();
-        }
-		timerUpdate.start(1000);
-	}
-	if (configwin->ui.checkBoxkSaveInterval->isChecked())
-	{
-		saveInterval ++;
-		if ((saveInterval/60) >= configwin->ui.spinBoxSaveInterval->value())
-		{
-			saveInterval = 0;
-			saveconfig(configfilename);
-		}
-	}
+            break;
+    }
+}
+
+
+
+
+void logisdom::updateFinished()
+{
+    GenMsg("Update finished : " + updatePipeline.timings());
+    mainStatus();
 }
 
 
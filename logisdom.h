@@ -36,8 +36,11 @@
 #include <QtWidgets/QToolBar>
 #include <QtGui>
 #include <QTimer>
+#include <csignal>
 #include "iconearea.h"
 #include "filesave.h"
+#include "logwriter.h"
+#include "updatepipeline.h"
 #include "ui_mainw.h"
 #include "../plugins/interface.h"
 
@@ -122,6 +125,7 @@ const static int iconSize = 48;
 const static int statusIconSize = 32;
 const static int PaletteWidth = 5;
 static bool NoHex;
+static volatile sig_atomic_t terminateRequest;
     enum InitMode	{	Normal, RemoteConfig	};
 	enum htmlStyle	{	htmlStyleMenu, htmlStyleTime, htmlStyleList, htmlStyleDetector, htmlStyleValue, htmlStyleCommand };
     logisdom(QWidget *parent = nullptr);
@@ -237,6 +241,8 @@ static bool NoHex;
 	void setBinderCommand(QString command);
 	QList <QTreeWidgetItem*> treeItemList;
 	QList <htmlBinder*> htmlBinderList;
+	QHash <QTreeWidgetItem*, htmlBinder*> treeItemBinder;
+	quint64 htmlBinderRevision = 0;
 	QUuid binderID;
 	QString getHtmlRequest(QString &Request, QString &WebID, int Privilege);
 	void declareHtmlMenu(QString menuString);
@@ -263,7 +269,10 @@ static bool NoHex;
     void PaletteClear();
     bool isPaletteHidden();
     bool getTabPix(const QString &name, QBuffer &buffer);
-    void logthis(const QString &filename, const QString &log, QString S = "");
+    qint64 getTabRevision(const QString &name);
+    QString getTabPixKey(const QString &name);
+    void logthis(const QString &filename, const QString &log, QString S = "", int level = logwriter::logActivity);
+    void setLogSettings(qint64 maxSize, int minSeverity);
 	void logfile(const QString &log, const QString &S);
 	void logfile(const QString &log);
 	void GenError(int ErrID, QString Msg);
@@ -292,9 +301,8 @@ static bool NoHex;
 private:
     QDir pluginsDir;
     void loadPlugins();
-    int indexupdate;
+    updatepipeline updatePipeline;
 	QMutex mutexFifoEmpty;
-	QMutex mutexLog;
 	QMutex MutexGenMsg;
     QTimer timerUpdate;
 	void closeEvent(QCloseEvent *event);
@@ -309,6 +317,7 @@ private:
 	int saveInterval;
 	QString strCopyIcon;
     fileSave fileSaver;
+    logwriter logger;
     void setTabWidget(int);
     void changePalette(QWidget *setup);
     void checkSetupParent(QWidget *);
@@ -375,10 +384,13 @@ private slots:
     void newPluginDeviceValue(QString, QString);
     void pluginDeviceSelected(QString);
     void pluginUpdateNames(LogisDomInterface*, QString);
+    void runUpdateStage(int stage);
+    void updateFinished();
 public slots:
     void showPalette();
     void update(bool force = false);
     void mainStatus();
+    void shutdown();
 	void showconfig();
 	void restart();
     void restartnoconfirm();
@@ -22,10 +22,12 @@ HEADERS += ../plugins/interface.h \
  alarmwarn.h \
  axb.h \
  backup.h \
+ bustransport.h \
  calcthread.h \
  calc.h \
  chauffageunit.h \
  histo.h \
+ configindex.h \
  configmanager.h \
  configwindow.h \
  commonstring.h \
@@ -36,6 +38,7 @@ HEADERS += ../plugins/interface.h \
  deadevice.h \
  devchooser.h \
  devfinder.h \
+ deviceregistry.h \
  devrps2.h \
  devresol.h \
  devvirtual.h \
@@ -48,6 +51,7 @@ HEADERS += ../plugins/interface.h \
  graphconfig.h \
  highlighter.h \
  htmlbinder.h \
+ htmltemplate.h \
  iconearea.h \
  iconf.h \
  icont.h \
@@ -56,6 +60,7 @@ HEADERS += ../plugins/interface.h \
  lcdonewire.h \
  ledonewire.h \
  linecoef.h \
+ logwriter.h \
  logisdom.h \
  mailsender.h \
  messagebox.h \
@@ -68,6 +73,7 @@ HEADERS += ../plugins/interface.h \
  programevent.h \
  remote.h \
  reprocessthread.h \
+ scheduler.h \
  rps2.h \
  resol.h \
  server.h \
@@ -79,8 +85,10 @@ HEADERS += ../plugins/interface.h \
  tcpdata.h \
  textedit.h \
  treehtmlwidget.h \
+ updatepipeline.h \
  vmc.h \
  weathercom.h \
+ zipcompactor.h \
  remotethread.h
 
 FORMS += addProgram.ui \
@@ -111,8 +119,10 @@ SOURCES += addDaily.cpp \
  alarmwarn.cpp \
  axb.cpp \
  backup.cpp \
+ bustransport.cpp \
  chauffageunit.cpp \
  histo.cpp \
+ configindex.cpp \
  configmanager.cpp \
  configwindow.cpp \
  connection.cpp \
@@ -121,6 +131,7 @@ SOURCES += addDaily.cpp \
  daily.cpp \
  dataloader.cpp \
  devfinder.cpp \
+ deviceregistry.cpp \
  devrps2.cpp \
  devresol.cpp \
  devvirtual.cpp \
@@ -135,6 +146,7 @@ SOURCES += addDaily.cpp \
  graphconfig.cpp \
  highlighter.cpp \
  htmlbinder.cpp \
+ htmltemplate.cpp \
  iconearea.cpp \
  iconf.cpp \
  icont.cpp \
@@ -143,6 +155,7 @@ SOURCES += addDaily.cpp \
  lcdonewire.cpp \
  ledonewire.cpp \
  linecoef.cpp \
+ logwriter.cpp \
  mailsender.cpp \
  main.cpp \
  meteo.cpp \
@@ -156,6 +169,7 @@ SOURCES += addDaily.cpp \
  programevent.cpp \
  remote.cpp \
  reprocessthread.cpp \
+ scheduler.cpp \
  rps2.cpp \
  resol.cpp \
  server.cpp \
@@ -167,6 +181,8 @@ SOURCES += addDaily.cpp \
  tcpdata.cpp \
  textedit.cpp \
  treehtmlwidget.cpp \
+ updatepipeline.cpp \
  vmc.cpp \
  weathercom.cpp \
+ zipcompactor.cpp \
  remotethread.cpp
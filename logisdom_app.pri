@@ -0,0 +1,34 @@
+# Shared by the GUI build LogisDom.pro and the headless build LogisDomd.pro
+
+message(Project path : $$OUT_PWD)
+message(Source path : $$PWD)
+
+QWT_PATH = $${OUT_PWD}/qwt-6.2.0
+message(QWT path : $$QWT_PATH)
+LIBS += -lqwt -L$${QWT_PATH}/lib
+
+QUAZIP_PATH = $${OUT_PWD}/quazip
+message(Quazip path : $$QUAZIP_PATH)
+#LIBS *= -lquazip1-qt6 -L$${QUAZIP_PATH}/lib
+LIBS *= -lquazip -L$${QUAZIP_PATH}/lib
+
+#QT_NO_DEBUG_OUTPUT
+
+debug::BUILD_PATH = $$OUT_PWD/debug
+release::BUILD_PATH = $$OUT_PWD/release
+
+include (teleinfo/teleinfo.pri)
+#include (x10/x10.pri)
+#include (plcbus/plcbus.pri)
+include (devonewire/devonewire.pri)
+include (deveo/deveo.pri)
+include (ha7s/ha7s.pri)
+include (ha7net/ha7net.pri)
+include (enocean/enocean.pri)
+include (mbus/mbus.pri)
+include (fts800/fts800.pri)
+include (modbus/modbus.pri)
+include (ecogest/ecogest.pri)
+include (mail/mail.pri)
+include (logisdom.pri)
+
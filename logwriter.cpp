@@ -0,0 +1,270 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#include "globalvar.h"
+#include "logwriter.h"
+
+
+
+logwriter::logwriter()
+{
+    minSeverity = logActivity;
+    maxSize = 100000;
+    running = false;
+}
+
+
+
+
+logwriter::~logwriter()
+{
+    stop();
+    write(queue.fetchAndStoreAcquire(nullptr));
+}
+
+
+
+
+void logwriter::append(const QString &filename, const QString &log, const QString &S, int level)
+{
+    if (level < int(minSeverity)) return;
+    logEntry *entry = new logEntry;
+    entry->filename = filename;
+    entry->log = log;
+    entry->S = S;
+    entry->time = QDateTime::currentDateTime();
+    logEntry *head;
+    do
+    {
+        head = queue.loadAcquire();
+        entry->next = head;
+    }
+    while (!queue.testAndSetRelease(head, entry));
+    pending.release();
+}
+
+
+
+
+void logwriter::setMinSeverity(int level)
+{
+    minSeverity = level;
+}
+
+
+
+
+void logwriter::setMaxSize(qint64 size)
+{
+    QMutexLocker locker(&mutex);
+    maxSize = size;
+}
+
+
+
+
+void logwriter::open()
+{
+    running = true;
+    start(QThread::LowPriority);
+}
+
+
+
+
+void logwriter::stop()
+{
+    if (!isRunning()) return;
+    running = false;
+    pending.release();
+    wait();
+}
+
+
+
+
+void logwriter::run()
+{
+    while (running)
+    {
+        pending.tryAcquire(1, 1000);
+        pending.tryAcquire(pending.available());
+        write(queue.fetchAndStoreAcquire(nullptr));
+    }
+    write(queue.fetchAndStoreAcquire(nullptr));
+}
+
+
+
+
+QString logwriter::path(const QString &filename)
+{
+    return QString(repertoirelog) + QDir::separator() + filename + ".log";
+}
+
+
+
+
+// entries come newest first from the list, they are written in arrival order
+void logwriter::write(logEntry *entries)
+{
+    logEntry *ordered = nullptr;
+    while (entries)
+    {
+        logEntry *next = entries->next;
+        entries->next = ordered;
+        ordered = entries;
+        entries = next;
+    }
+    if (ordered && !QDir().exists(repertoirelog)) QDir().mkdir(repertoirelog);
+    while (ordered)
+    {
+        QString filename = ordered->filename;
+        if (!converted.contains(filename))
+        {
+            convertLegacy(filename);
+            converted.insert(filename);
+        }
+        QFile file(path(filename));
+        bool created = !file.exists();
+        bool opened = file.open(QIODevice::Append | QIODevice::Text);
+        if (opened && created) file.write((QDateTime::currentDateTime().toString() + " " + filename + ".log file created \n").toUtf8());
+        while (ordered && (ordered->filename == filename))
+        {
+            QString line;
+            if (ordered->S.isEmpty()) line = ordered->time.toString("dddd dd/MM/yyyy HH:mm:ss:zzz : ->  ") + ordered->log + "\n";
+            else line = ordered->time.toString() + " ->  " + ordered->log + " '" + ordered->S + "'" + "\n";
+            if (opened) file.write(line.toUtf8());
+            logEntry *done = ordered;
+            ordered = ordered->next;
+            delete done;
+        }
+        if (opened) file.close();
+        checkRotate(filename);
+    }
+}
+
+
+
+
+void logwriter::checkRotate(const QString &filename)
+{
+    QFileInfo info(path(filename));
+    if (!info.exists()) return;
+    QDate today = QDate::currentDate();
+    if (!started.contains(filename))
+    {
+#if QT_VERSION < 0x050A00
+        QDateTime birth = info.created();
+#else
+        QDateTime birth = info.birthTime();
+#endif
+        started.insert(filename, birth.isValid() ? birth.date() : today);
+    }
+    qint64 size;
+    {
+        QMutexLocker locker(&mutex);
+        size = maxSize;
+    }
+    if ((info.size() < size) && (started.value(filename).daysTo(today) < logRotateDays)) return;
+    QFile::remove(path(filename) + QString(".%1").arg(logHistory));
+    for (int n=logHistory-1; n>0; n--) QFile::rename(path(filename) + QString(".%1").arg(n), path(filename) + QString(".%1").arg(n + 1));
+    QFile::rename(path(filename), path(filename) + ".1");
+    started.insert(filename, today);
+}
+
+
+
+
+// Files written before the writer thread hold the newest line first and
+// end with their creation line
+bool logwriter::isLegacy(QFile &file)
+{
+    file.seek(qMax(qint64(0), file.size() - logTailChunk));
+    QList <QByteArray> tail = file.read(logTailChunk).trimmed().split('\n');
+    return tail.last().contains(".log file created");
+}
+
+
+
+
+// Only called by the writer thread, legacy files are turned over once
+void logwriter::convertLegacy(const QString &filename)
+{
+    QFile file(path(filename));
+    if (!file.open(QIODevice::ReadOnly)) return;
+    if (!isLegacy(file))
+    {
+        file.close();
+        return;
+    }
+    file.seek(0);
+    QList <QByteArray> lines = file.readAll().split('\n');
+    file.close();
+    lines.removeAll(QByteArray());
+    if (lines.count() < 2) return;
+    QSaveFile output(path(filename));
+    if (!output.open(QIODevice::WriteOnly)) return;
+    for (int n=lines.count()-1; n>=0; n--) output.write(lines.at(n) + "\n");
+    output.commit();
+}
+
+
+
+
+// Newest line first, the file is read backwards only as far as needed
+QStringList logwriter::lastLines(const QString &filename, int count)
+{
+    QStringList lines;
+    QFile file(path(filename));
+    if (!file.open(QIODevice::ReadOnly)) return lines;
+    if (isLegacy(file))
+    {
+// not turned over yet by the writer, the newest lines are at the top
+        file.seek(0);
+        while ((lines.count() < count) && !file.atEnd())
+        {
+            QString line = QString::fromUtf8(file.readLine()).trimmed();
+            if (!line.isEmpty()) lines.append(line);
+        }
+        file.close();
+        return lines;
+    }
+    qint64 pos = file.size();
+    QByteArray tail;
+    while ((pos > 0) && (tail.count('\n') <= count))
+    {
+        qint64 chunk = qMin(pos, qint64(logTailChunk));
+        pos -= chunk;
+        file.seek(pos);
+        tail.prepend(file.read(chunk));
+    }
+    file.close();
+    QStringList all = QString::fromUtf8(tail).split("\n");
+    if (pos > 0) all.removeFirst();
+    for (int n=all.count()-1; (n>=0) && (lines.count()<count); n--)
+        if (!all.at(n).isEmpty()) lines.append(all.at(n));
+    return lines;
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+#include <QThread>
+#include <QtCore>
+
+
+// Log files written by a single thread : callers push entries on a lock free
+// list and never wait for the disk, files are appended and rotated by size or age
+
+class logwriter : public QThread
+{
+    Q_OBJECT
+#define logHistory 3
+#define logRotateDays 30
+#define logTailChunk 4096
+public:
+    enum severity { logActivity, logWarning, logError };
+    logwriter();
+    ~logwriter();
+    void run();
+    void append(const QString &filename, const QString &log, const QString &S = "", int level = logActivity);
+    void open();
+    void stop();
+    static QString path(const QString &filename);
+    static QStringList lastLines(const QString &filename, int count);
+    void setMinSeverity(int level);
+    void setMaxSize(qint64 size);
+private:
+    struct logEntry
+    {
+        QString filename;
+        QString log;
+        QString S;
+        QDateTime time;
+        logEntry *next;
+    };
+    QAtomicPointer <logEntry> queue;
+    QSemaphore pending;
+    QAtomicInt minSeverity;
+    QMutex mutex;
+    qint64 maxSize;
+    bool running;
+    QHash <QString, QDate> started;
+    QSet <QString> converted;
+    void write(logEntry *entries);
+    void checkRotate(const QString &filename);
+    static bool isLegacy(QFile &file);
+    static void convertLegacy(const QString &filename);
+};
+
+#endif // LOGWRITER_H
@@ -67,6 +67,30 @@ class LogisDomApplication : public QApplication
 public:
     LogisDomApplication(int& argc, char** argv) : QApplication(argc, argv)
     {}
+#ifdef LOGISDOM_HEADLESS
+// no one to click a message box, the exception is logged and the daemon stops
+    bool notify(QObject* receiver, QEvent *event)
+    {
+        try
+        {
+            return QApplication::notify(receiver, event);
+        }
+        catch(std::exception const& ex)
+        {
+            qCritical() << "Exception :" << ex.what();
+        }
+        catch(const QString& ex)
+        {
+            qCritical() << "Exception :" << ex;
+        }
+        catch(...)
+        {
+            qCritical() << "Exception : Erreur inconnue";
+        }
+        QCoreApplication::exit(1);
+        return false;
+    }
+#else
     bool notify(QObject* receiver, QEvent *event)
     {
         try
@@ -110,12 +134,21 @@ public:
         }
     return false;
     }
+#endif
 };
 
 
 
 
 #ifdef Q_OS_LINUX
+#ifdef LOGISDOM_HEADLESS
+void handleTerminate(int)
+{
+	logisdom::terminateRequest = 1;
+}
+#endif
+
+
 void handleSigpipe(int signum)
 {
 	QFile file("sigpipe.log");
@@ -138,6 +171,9 @@ void handleSigpipe(int signum)
 int main(int argc, char *argv[])
 {
 	Q_INIT_RESOURCE(onewire);
+#ifdef LOGISDOM_HEADLESS
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
 	LogisDomApplication appmaison1wire(argc, argv);
 	QString locale = QLocale::system().name();
     if (tr.load(QString("logisdom_") + locale, QString("trans"))) tr.load(QString("logisdom_fr") , QString("trans"));
@@ -145,14 +181,23 @@ int main(int argc, char *argv[])
     if ((Qtr.load(QDir::separator() + QString("qt_") + locale, QString("trans")))) appmaison1wire.installTranslator(&Qtr);
 #ifdef Q_OS_LINUX
 	signal(SIGPIPE, handleSigpipe);
+#ifdef LOGISDOM_HEADLESS
+	signal(SIGTERM, handleTerminate);
+	signal(SIGINT, handleTerminate);
+#endif
 #endif
 #ifdef Q_OS_WIN32
 #endif
     //    QMessageBox::warning(0, QObject::tr("Warning Title"), QObject::tr("Warning Message"), QMessageBox::Ok|QMessageBox::Cancel);
 	maison1wirewindow = new logisdom();
+#ifdef LOGISDOM_HEADLESS
+	appmaison1wire.setQuitOnLastWindowClosed(false);
+	maison1wirewindow->init(argv);
+#else
 	maison1wirewindow->show();
 	maison1wirewindow->init(argv);
 	appmaison1wire.connect(&appmaison1wire, SIGNAL(lastWindowClosed()), &appmaison1wire, SLOT(quit()));
+#endif
     appmaison1wire.addLibraryPath("lib");
     qDebug() << QApplication::font();
     try
@@ -161,13 +206,23 @@ int main(int argc, char *argv[])
     }
     catch(const QString& ex)
     {
+#ifdef LOGISDOM_HEADLESS
+        qCritical() << "Exception :" << ex;
+        return 1;
+#else
         QMessageBox::critical(nullptr, "Exception", ex);
         return 0;
+#endif
     }
     catch(...)
     {
+#ifdef LOGISDOM_HEADLESS
+        qCritical() << "Exception : Erreur inconnue";
+        return 1;
+#else
         QMessageBox::critical(nullptr, "Exception", "Erreur inconnue");
         return 0;
+#endif
     }
 }
 
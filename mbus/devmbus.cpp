@@ -231,7 +231,12 @@ void devmbus::setconfig(const QString &strsearch)
         else setname(assignname(tr("MBus device ")));
     }
     QString MBusAdr = logisdom::getvalue("MBusAdr", strsearch);
-    if (!MBusAdr.isEmpty()) AdrId.setText(MBusAdr);
+    if (!MBusAdr.isEmpty())
+    {
+        AdrId.setText(MBusAdr);
+        mbus *bus = qobject_cast<mbus*>(master);
+        if (bus) bus->setDeviceAdr(this, MBusAdr);
+    }
     QString MBusDatId = logisdom::getvalue("MBusDatId", strsearch);
     if (!MBusDatId.isEmpty()) DatId.setText(MBusDatId);
     //QString MBusDatStr = logisdom::getvalue("MBusDatStr", strsearch).replace('[', "(").replace(']', ")");
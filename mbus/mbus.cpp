@@ -59,7 +59,7 @@ mbus::mbus(logisdom *Parent) : net1wire(Parent)
     connect(&mbusThread, SIGNAL(setTreeItem(QString)), this, SLOT(setTreeItem(QString)), Qt::QueuedConnection);
     connect(&mbusThread, SIGNAL(setMainTreeItem(QString)), this, SLOT(setTreeItem(QString)), Qt::QueuedConnection);
     connect(&mbusThread, SIGNAL(whatdoUDo(QString)), this, SLOT(whatdoUDo(QString)), Qt::QueuedConnection);
-    connect(&mbusThread, SIGNAL(ReadingDone()), this, SLOT(ReadingDone()), Qt::QueuedConnection);
+    connect(&mbusThread, SIGNAL(ReadingDone(int)), this, SLOT(ReadingDone(int)), Qt::QueuedConnection);
     connect(&mbusThread, SIGNAL(ReadingDevDone()), this, SLOT(ReadingDevDone()), Qt::QueuedConnection);
     connect(&mbusThread, SIGNAL(CheckDev()), this, SLOT(CheckDev()), Qt::QueuedConnection);
     connect(this, SIGNAL(appendAdr(QString)), &mbusThread, SLOT(appendAdr(QString)), Qt::QueuedConnection);
@@ -116,6 +116,13 @@ void mbus::init()
                 config += logisdom::saveformat("MBusAdr", MBusAdr);
                 config += logisdom::saveformat("MBusDatId", MBusDatId);
                 device->setconfig(config);
+                bool ok;
+                int adr = QString(MBusAdr).remove("Adr ").toInt(&ok);
+                if (ok)
+                {
+                    mbusThread.addMeter(adr);
+                    newTreeAddress(adr);
+                }
             }
         }
     SearchLoopEnd
@@ -178,7 +185,7 @@ void mbus::searchMaxChanged(int max)
 
 void mbus::searchClicked()
 {
-    mbusThread.searchDone = false;
+    mbusThread.restartSearch();
 }
 
 
@@ -243,6 +250,7 @@ void mbus::newTreeAddress(int adr)
     }
     QTreeWidgetItem *item = new QTreeWidgetItem(uiw.treeWidget, 0);
     item->setText(0, QString("Adr %1").arg(adr));
+    showMeterPeriod(item, meterPeriods.value(adr, 0));
 }
 
 
@@ -339,10 +347,30 @@ QTreeWidgetItem *mbus::getTree(const QString &adr, const QString &record)
 
 
 
-void mbus::ReadingDone()
+// Devices are indexed by meter address when their address is set, an empty address only removes the device
+void mbus::setDeviceAdr(onewiredevice *device, const QString &MBusAdr)
 {
-    for (int n=0; n<localdevice.count(); n++)
-        localdevice.at(n)->lecturerec();
+    foreach (int adr, meterDevices.keys()) meterDevices[adr].removeAll(device);
+    bool ok;
+    int adr = QString(MBusAdr).remove("Adr ").toInt(&ok);
+    if (ok) meterDevices[adr].append(device);
+}
+
+
+
+
+bool mbus::removeDeviceFromCatalog(onewiredevice *device)
+{
+    setDeviceAdr(device, "");
+    return net1wire::removeDeviceFromCatalog(device);
+}
+
+
+
+
+void mbus::ReadingDone(int adr)
+{
+    foreach (onewiredevice *device, meterDevices.value(adr)) device->lecturerec();
 }
 
 
@@ -382,8 +410,13 @@ void mbus::CheckDev()
 void mbus::rightclicklist(const QPoint &pos)
 {
     QTreeWidgetItem *item = uiw.treeWidget->currentItem();
+    if (!item) return;
     QTreeWidgetItem *record = item->parent();
-    if (!record) return;
+    if (!record)
+    {
+        meterMenu(item, pos);
+        return;
+    }
     QString Adr = record->text(0);
     QString DatId = item->text(0);
     QString RomID = item->text(4);
@@ -411,6 +444,7 @@ void mbus::rightclicklist(const QPoint &pos)
                         {
                             //dev = localdevice.at(n);
                             //parent->configwin->removeDevice(dev);
+                            setDeviceAdr(localdevice.at(n), "");
                             localdevice.removeAt(n);
                             msgBox.setText(tr("Done"));
                             msgBox.setInformativeText(tr("Please save and restart the application"));
@@ -450,6 +484,55 @@ void mbus::rightclicklist(const QPoint &pos)
 
 
 
+void mbus::meterMenu(QTreeWidgetItem *item, const QPoint &pos)
+{
+    bool ok;
+    int adr = item->text(0).remove("Adr ").toInt(&ok);
+    if (!ok) return;
+    int current = meterPeriods.value(adr, 0);
+    QMenu contextualmenu;
+    QMenu *intervalMenu = contextualmenu.addMenu(tr("Read interval"));
+    QAction *actionDefault = intervalMenu->addAction(tr("Module interval"));
+    actionDefault->setCheckable(true);
+    actionDefault->setChecked(current == 0);
+    intervalMenu->addSeparator();
+    QList <QAction*> actions;
+    for (int n=0; n<uiw.ReadInterval->count(); n++)
+    {
+        QAction *action = intervalMenu->addAction(uiw.ReadInterval->itemText(n));
+        action->setCheckable(true);
+        action->setChecked(current == mbusthread::intervalSecs(n));
+        actions.append(action);
+    }
+    QAction *selection = contextualmenu.exec(uiw.treeWidget->mapToGlobal(pos));
+    if (!selection) return;
+    int secs = 0;
+    int index = actions.indexOf(selection);
+    if (index != -1) secs = mbusthread::intervalSecs(index);
+    else if (selection != actionDefault) return;
+    if (secs) meterPeriods.insert(adr, secs);
+    else meterPeriods.remove(adr);
+    mbusThread.setMeterPeriod(adr, secs);
+    showMeterPeriod(item, secs);
+}
+
+
+
+
+void mbus::showMeterPeriod(QTreeWidgetItem *item, int secs)
+{
+    if (secs == 0)
+    {
+        item->setText(1, "");
+        return;
+    }
+    for (int n=0; n<uiw.ReadInterval->count(); n++)
+        if (mbusthread::intervalSecs(n) == secs) item->setText(1, uiw.ReadInterval->itemText(n));
+}
+
+
+
+
 QString mbus::getScratchPad(const QString &RomID, int)
 {
     for (int n=0; n<localdevice.count(); n++)
@@ -603,6 +686,11 @@ void mbus::getConfig(QString &str)
 {
     str += logisdom::saveformat("searchMax", QString("%1").arg(uiw.spinBoxSearchMax->value()));
     str += logisdom::saveformat("ReadInterval", QString("%1").arg(uiw.ReadInterval->currentIndex()));
+    QStringList periods;
+    QHash <int, int>::const_iterator it;
+    for (it = meterPeriods.constBegin(); it != meterPeriods.constEnd(); ++it)
+        periods.append(QString("%1:%2").arg(it.key()).arg(it.value()));
+    str += logisdom::saveformat("MeterPeriods", periods.join(","));
 }
 
 
@@ -623,6 +711,18 @@ void mbus::setConfig(const QString &strsearch)
     if (RI < 0) RI = 1;
     uiw.ReadInterval->setCurrentIndex(int(RI));
     readIntervalChanged(int(RI));
+    QStringList periods = logisdom::getvalue("MeterPeriods", strsearch).split(",");
+    for (int n=0; n<periods.count(); n++)
+    {
+        bool okAdr, okSecs;
+        int adr = periods.at(n).section(':', 0, 0).toInt(&okAdr);
+        int secs = periods.at(n).section(':', 1, 1).toInt(&okSecs);
+        if (okAdr && okSecs && (secs > 0))
+        {
+            meterPeriods.insert(adr, secs);
+            mbusThread.setMeterPeriod(adr, secs);
+        }
+    }
 }
 
 
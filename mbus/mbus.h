@@ -49,6 +49,8 @@ public:
     QStringList devicesScratchPad;
     QString getScratchPad(const QString &RomID, int scratchpad_ID = 0);
     void switchOnOff(bool state);
+    void setDeviceAdr(onewiredevice *device, const QString &MBusAdr);
+    bool removeDeviceFromCatalog(onewiredevice *device);
 private:
     Ui::mbus uiw;
     mbusthread mbusThread;
@@ -59,6 +61,10 @@ private:
     QTreeWidgetItem *getTree(const QString &adr);
     QTreeWidgetItem *getTree(const QString &adr, const QString &record);
     void setScratchPad(const QString &RomID, const QString &Value);
+    QHash <int, int> meterPeriods;
+    QHash <int, QList <onewiredevice*> > meterDevices;
+    void meterMenu(QTreeWidgetItem *item, const QPoint &pos);
+    void showMeterPeriod(QTreeWidgetItem *item, int secs);
 private slots:
     void tcpStatusUpdate(const QString&);
     void tcpStatusChange();
@@ -71,7 +77,7 @@ private slots:
     void setMainTreeItem(const QString&);
     void whatdoUDo(const QString);
     void rightclicklist(const QPoint &pos);
-    void ReadingDone();
+    void ReadingDone(int adr);
     void ReadingDevDone();
     void CheckDev();
 signals:
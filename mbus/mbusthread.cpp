@@ -43,6 +43,9 @@ mbusthread::mbusthread()
     readInterval = 0;
     searchMax = 10;
     searchDone = false;
+    searchAdr = 0;
+    periodsChanged = false;
+    scheduledInterval = -1;
  }
 
 
@@ -59,11 +62,57 @@ mbusthread::~mbusthread()
 
 void mbusthread::appendAdr(const QString &str)
 {
+    QMutexLocker locker(&mutexData);
     adrToRead.append(str);
 }
 
 
 
+void mbusthread::addMeter(int adr)
+{
+    QMutexLocker locker(&mutexData);
+    QString adrStr = QString("%1").arg(adr);
+    if (!devices.contains(adrStr)) devices.append(adrStr);
+}
+
+
+
+void mbusthread::setMeterPeriod(int adr, int secs)
+{
+    QMutexLocker locker(&mutexData);
+    if (secs > 0) meterPeriods.insert(adr, secs);
+    else meterPeriods.remove(adr);
+    periodsChanged = true;
+}
+
+
+
+void mbusthread::restartSearch()
+{
+    QMutexLocker locker(&mutexData);
+    searchAdr = 0;
+    searchDone = false;
+}
+
+
+
+int mbusthread::intervalSecs(int index)
+{
+    switch (index)
+    {
+        case mbus::Reading5mn : return 300;
+        case mbus::Reading10mn : return 600;
+        case mbus::Reading15mn : return 900;
+        case mbus::Reading20mn : return 1200;
+        case mbus::Reading30mn : return 1800;
+        case mbus::Reading1h : return 3600;
+        case mbus::Reading1d : return 86400;
+    }
+    return 60;
+}
+
+
+
 void mbusthread::mbus_setType(mbus_frame &frame, int frame_type)
 {
     frame.type = frame_type;
@@ -101,7 +150,6 @@ void mbusthread::run()
 {
 #define addTimeTag "\r" + QDateTime::currentDateTime().toString("HH:mm:ss:zzz  ") +
 #define PACKET_BUFF_SIZE 128
-#define addTimeTag "\r" + QDateTime::currentDateTime().toString("HH:mm:ss:zzz  ") +
     QTcpSocket MySocket;
     int sd = MySocket.socketDescriptor();
     int set = 1;
@@ -112,131 +160,202 @@ void mbusthread::run()
     //setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, (void *)&set, sizeof(int));
 #endif
     int fileIndex = 0;
-    int minute = -1;
     int minuteCheckDev = QDateTime::currentDateTime().time().minute();
+    bool idle = false;
+    link.setOwner(this, &log, &endLessLoop, &logEnabled);
+    link.setSocket(&MySocket, &tcpStatus);
+    link.setFrameSize(frameLength);
     QString msg = "Thread starts, first connection";
     TCPconnect(MySocket, msg);
+// Requested reads first, then meters whose deadline passed, address search when the bus is free
     while (endLessLoop)
     {
-// Search sequence
-        if (!searchDone)
-        {
-            searchMbus(MySocket);
-            if (logEnabled) log += addTimeTag "********************     Adress found   ********************************";
-            if (logEnabled) for (int n=0; n<devices.count(); n++) log += addTimeTag "Adress " + devices.at(n);
-            if (logEnabled) log += addTimeTag "*************************************************************************************";
-            searchDone = true;
-        }
-// Read All addresses
-        QStringList adrStr;
-        for (int n=0; n<devices.count(); n++)
+        if (QDateTime::currentDateTime().time().minute() != minuteCheckDev)
         {
-            bool ok;
-            int adr = devices.at(n).toInt(&ok);
-            if (ok)
-            {
-                QString s = QString("%1").arg(adr);
-                if (!adrStr.contains(s))
-                {
-                    readMbus(MySocket, adr);
-                    adrStr.append(s);
-                }
-            }
+            minuteCheckDev = QDateTime::currentDateTime().time().minute();
+            emit(CheckDev());
         }
-        emit(ReadingDone());
-        if (readInterval == mbus::Reading1d)
+        bool busy = readRequested(MySocket);
+        if (!busy) busy = readDue(MySocket);
+        if (!busy && !searchDone)
         {
-            QString str = tr("Wait next day, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            int today = QDateTime::currentDateTime().date().day();
-            while ((today == QDateTime::currentDateTime().date().day()) && endLessLoop && searchDone) { MBusReadLoop; }
+            searchStep(MySocket);
+            busy = true;
         }
-        else if (readInterval == mbus::Reading1h)
+        if (busy)
         {
-            QString str = tr("Wait next hour, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            int hour = QDateTime::currentDateTime().time().hour();
-            while ((hour == QDateTime::currentDateTime().time().hour()) && endLessLoop && searchDone) { MBusReadLoop; }
-        }
-        else if (readInterval == mbus::Reading30mn)
-        {
-            if (minute < 0) minute = QDateTime::currentDateTime().time().minute();
-            minute += 30;
-            while (minute > 59) minute -=60;
-            QString str = tr("Wait 30mn, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            while ((minute != QDateTime::currentDateTime().time().minute()) && endLessLoop && searchDone) { MBusReadLoop; }
-        }
-        else if (readInterval == mbus::Reading20mn)
-        {
-            if (minute < 0) minute = QDateTime::currentDateTime().time().minute();
-            minute += 20;
-            while (minute > 59) minute -=60;
-            QString str = tr("Wait 20mn, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            while ((minute != QDateTime::currentDateTime().time().minute()) && endLessLoop && searchDone) { MBusReadLoop; }
-        }
-        else if (readInterval == mbus::Reading15mn)
-        {
-            if (minute < 0) minute = QDateTime::currentDateTime().time().minute();
-            minute += 15;
-            while (minute > 59) minute -=60;
-            QString str = tr("Wait 15mn, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            while ((minute != QDateTime::currentDateTime().time().minute()) && endLessLoop && searchDone) { MBusReadLoop; }
-        }
-        else if (readInterval == mbus::Reading10mn)
-        {
-            if (minute < 0) minute = QDateTime::currentDateTime().time().minute();
-            minute += 10;
-            while (minute > 59) minute -=60;
-            QString str = tr("Wait 10mn, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            while ((minute != QDateTime::currentDateTime().time().minute()) && endLessLoop && searchDone) { MBusReadLoop; }
-        }
-        else if (readInterval == mbus::Reading5mn)
-        {
-            if (minute < 0) minute = QDateTime::currentDateTime().time().minute();
-            minute += 5;
-            while (minute > 59) minute -=60;
-            QString str = tr("Wait 5mn, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
-            emit(whatdoUDo(str));
-            while ((minute != QDateTime::currentDateTime().time().minute()) && endLessLoop && searchDone) { MBusReadLoop; }
+            idle = false;
+            continue;
         }
-        else
+        if (!idle)
         {
-            QString str = tr("Wait next minute, last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm");
+            idle = true;
+            saveLog(fileIndex);
+            QString str = tr("Last read : ") + QDateTime::currentDateTime().toString("dd-MM hh:mm:ss");
+            if (!agenda.isEmpty()) str += tr(", next read : ") + QDateTime::fromMSecsSinceEpoch(agenda.firstKey()).toString("dd-MM hh:mm:ss");
             emit(whatdoUDo(str));
-            minute = QDateTime::currentDateTime().time().minute();
-            while ((minute == QDateTime::currentDateTime().time().minute()) && endLessLoop && searchDone) { MBusReadLoop; }
         }
-        if (logEnabled)
+        msleep(schedulerTick);
+    }
+    link.disconnectLink();
+}
+
+
+
+
+void mbusthread::saveLog(int &fileIndex)
+{
+    if (logEnabled && !log.isEmpty())
+    {
+        log += addTimeTag link.statistics();
+        QString filename = moduleipaddress;
+        filename.remove(".");
+        filename += QString("_%1.txt").arg(fileIndex);
+        QFile file(filename);
+        QTextStream out(&file);
+        file.open(QIODevice::WriteOnly | QIODevice::Text);
+        out << log;
+        file.close();
+        fileIndex++;
+        if (fileIndex > 999) fileIndex = 0;
+        emit(tcpStatusUpdate(log));
+    }
+    log.clear();
+}
+
+
+
+
+int mbusthread::meterPeriod(int adr)
+{
+    QMutexLocker locker(&mutexData);
+    int secs = meterPeriods.value(adr, 0);
+    if (secs > 0) return secs;
+    return intervalSecs(readInterval);
+}
+
+
+
+
+qint64 mbusthread::nextDeadline(qint64 now, int secs)
+{
+// Periods dividing a day stay aligned on wall clock boundaries (hh:00, hh:15, midnight ...)
+    if (secs <= 0) secs = 60;
+    if ((86400 % secs) == 0)
+    {
+        QDateTime current = QDateTime::fromMSecsSinceEpoch(now);
+        qint64 midnight = QDateTime(current.date(), QTime(0, 0)).toMSecsSinceEpoch();
+        qint64 slot = (now - midnight) / (qint64(secs) * 1000) + 1;
+        return midnight + slot * qint64(secs) * 1000;
+    }
+    return now + qint64(secs) * 1000;
+}
+
+
+
+
+void mbusthread::updateSchedule(qint64 now)
+{
+    mutexData.lock();
+    QStringList adrList = devices;
+    bool reschedule = periodsChanged || (scheduledInterval != readInterval);
+    periodsChanged = false;
+    scheduledInterval = readInterval;
+    mutexData.unlock();
+    if (reschedule)
+    {
+        agenda.clear();
+        QHash <int, meterState>::iterator it;
+        for (it = meters.begin(); it != meters.end(); ++it)
         {
-            QString filename = moduleipaddress;
-            filename.remove(".");
-            filename += QString("_%1.txt").arg(fileIndex);
-            QFile file(filename);
-            QTextStream out(&file);
-            file.open(QIODevice::WriteOnly | QIODevice::Text);
-            out << log;
-            file.close();
-            fileIndex++;
-            if (fileIndex > 999) fileIndex = 0;
-            emit(tcpStatusUpdate(log));
+            it.value().period = meterPeriod(it.key());
+            it.value().nextRead = nextDeadline(now, it.value().period);
+            agenda.insert(it.value().nextRead, it.key());
         }
-        log.clear();
-        sleep(1);
     }
-    MySocket.disconnectFromHost();
-    if (MySocket.state() != QAbstractSocket::UnconnectedState) MySocket.waitForDisconnected();
-    tcpStatus = MySocket.state();
-    emit(tcpStatusChange());
+// New meters are read at once
+    for (int n=0; n<adrList.count(); n++)
+    {
+        bool ok;
+        int adr = adrList.at(n).toInt(&ok);
+        if (!ok || meters.contains(adr)) continue;
+        meterState meter;
+        meter.period = meterPeriod(adr);
+        meter.nextRead = now;
+        meter.failures = 0;
+        meters.insert(adr, meter);
+        agenda.insert(now, adr);
+    }
+}
+
+
+
+
+bool mbusthread::readDue(QTcpSocket &Socket)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    updateSchedule(now);
+    if (agenda.isEmpty()) return false;
+    QMultiMap <qint64, int>::iterator it = agenda.begin();
+    if (it.key() > now) return false;
+    int adr = it.value();
+    agenda.erase(it);
+    int status = readMbus(Socket, adr);
+    meterState &meter = meters[adr];
+    now = QDateTime::currentMSecsSinceEpoch();
+    if (status == readDone)
+    {
+        meter.failures = 0;
+        meter.nextRead = nextDeadline(now, meter.period);
+        emit(ReadingDone(adr));
+    }
+    else if (status == readBadFrame)
+    {
+// The meter answered, it keeps its period
+        meter.failures = 0;
+        meter.nextRead = nextDeadline(now, meter.period);
+        if (logEnabled) log += addTimeTag QString("Adress %1 answer could not be parsed").arg(adr);
+    }
+    else
+    {
+// Silent meter : back off so its timeouts do not eat the bus time of the others
+        meter.failures++;
+        qint64 delay = qint64(meter.period) << qMin(meter.failures - 1, 3);
+        delay = qMin(delay, qMax(qint64(meter.period), qint64(maxBackoff)));
+        meter.nextRead = now + delay * 1000;
+        if (logEnabled) log += addTimeTag QString("Adress %1 no answer (%2), next try in %3s").arg(adr).arg(meter.failures).arg(delay);
+    }
+    agenda.insert(meter.nextRead, adr);
+    return true;
 }
 
 
 
 
-void mbusthread::readMbus(QTcpSocket &Socket, int adr)
+bool mbusthread::readRequested(QTcpSocket &Socket)
+{
+    mutexData.lock();
+    QString Adr;
+    if (!adrToRead.isEmpty()) Adr = adrToRead.takeFirst();
+    bool last = adrToRead.isEmpty();
+    mutexData.unlock();
+    if (Adr.isEmpty()) return false;
+    bool ok;
+    int adr = Adr.remove("Adr ").toInt(&ok);
+    if (ok) readMbus(Socket, adr);
+    else emit(whatdoUDo(tr("Can't Read : ") + Adr + QDateTime::currentDateTime().toString(" hh:mm")));
+    if (last)
+    {
+        emit(ReadingDevDone());
+        emit(whatdoUDo(tr("Read Device finished ") + QDateTime::currentDateTime().toString(" hh:mm")));
+    }
+    return true;
+}
+
+
+
+
+int mbusthread::readMbus(QTcpSocket &Socket, int adr)
 {
     QString str = tr("Reading MBus address") + QString(" %1").arg(adr);
     emit(whatdoUDo(str));
@@ -247,16 +366,19 @@ void mbusthread::readMbus(QTcpSocket &Socket, int adr)
     frame.address = adr;
     data.clear();
     if (logEnabled) log += addTimeTag QString("Get device data");
-    get(Socket, frame, data, 1000);
-    mbus_frame_data frame_data;
+    get(Socket, frame, data, frameTimeout);
+    bool answer = !data.isEmpty();
+    bool parsed = false;
+    frameData.data_var.records.clear();
     if (!data.isEmpty())
     {
         mbus_frame reply;
-        if (mbus_parse(reply, data)) return;
+        if (mbus_parse(reply, data)) return readBadFrame;
+        parsed = true;
         QString logtxt;
         for (unsigned int n=0; n<reply.data_size; n++) logtxt += QString("[%1]").arg((unsigned char)reply.data[n]);
         if (logEnabled) log += addTimeTag "Data after parsing : " + logtxt;
-        mbus_frame_data_parse(reply, frame_data, adr);
+        mbus_frame_data_parse(reply, frameData, adr);
     }
 // DonnÃ©e instantanÃ©e
     mbus_setType(frame, MBUS_FRAME_TYPE_CONTROL);
@@ -265,92 +387,64 @@ void mbusthread::readMbus(QTcpSocket &Socket, int adr)
     frame.address = adr;
     data.clear();
     if (logEnabled) log += addTimeTag QString("Get device real time data");
-    get(Socket, frame, data, 1000);
+    get(Socket, frame, data, frameTimeout);
     if (!data.isEmpty())
     {
+        answer = true;
         mbus_frame reply;
        // mbus_frame_data frame_data;
-        if (mbus_parse(reply, data)) return;
+        if (mbus_parse(reply, data)) return parsed ? readDone : readBadFrame;
+        parsed = true;
         if (logEnabled)
         {
             QString logtxt;
             for (unsigned int n=0; n<reply.data_size; n++) logtxt += QString("[%1]").arg((unsigned char)reply.data[n]);
             log += addTimeTag "Real time data after parsing : " + logtxt;
         }
-        mbus_frame_data_parse(reply, frame_data, adr);
+        mbus_frame_data_parse(reply, frameData, adr);
     }
-    for (int n=0; n<frame_data.data_var.records.count(); n++) delete frame_data.data_var.records.at(n);
+    if (parsed) return readDone;
+    return answer ? readBadFrame : readNoAnswer;
 }
 
 
 
 
-void mbusthread::searchMbus(QTcpSocket &Socket)
+void mbusthread::searchStep(QTcpSocket &Socket)
 {
-    for (int adr=0; adr<searchMax; adr++)
+// One address per call so scheduled reads go on while the bus is scanned
+    mutexData.lock();
+    int adr = searchAdr++;
+    bool finished = (adr >= searchMax);
+    if (finished) searchDone = true;
+    QStringList adrList = devices;
+    mutexData.unlock();
+    if (finished)
     {
-        QString str = tr("Searching/Reading MBus address") + QString(" %1").arg(adr);
-        emit(whatdoUDo(str));
-        mbus_frame frame;
-        mbus_setType(frame, MBUS_FRAME_TYPE_SHORT);
-        frame.control = MBUS_CONTROL_MASK_SND_NKE | MBUS_CONTROL_MASK_DIR_M2S; // data request from master to slave
-        frame.address = adr;
-        QByteArray data;
-        if (logEnabled) log += addTimeTag QString("Search at adress %1").arg(adr);
-        get(Socket, frame, data, 1000);
-        if (!data.isEmpty())
+        if (logEnabled) log += addTimeTag "********************     Adress found   ********************************";
+        if (logEnabled) for (int n=0; n<adrList.count(); n++) log += addTimeTag "Adress " + adrList.at(n);
+        if (logEnabled) log += addTimeTag "*************************************************************************************";
+        return;
+    }
+    QString str = tr("Searching MBus address") + QString(" %1").arg(adr);
+    emit(whatdoUDo(str));
+    mbus_frame frame;
+    mbus_setType(frame, MBUS_FRAME_TYPE_SHORT);
+    frame.control = MBUS_CONTROL_MASK_SND_NKE | MBUS_CONTROL_MASK_DIR_M2S; // data request from master to slave
+    frame.address = adr;
+    QByteArray data;
+    if (logEnabled) log += addTimeTag QString("Search at adress %1").arg(adr);
+    get(Socket, frame, data, frameTimeout);
+    if (!data.isEmpty())
+    {
+        if (data.at(0) == MBUS_FRAME_ACK_START)
         {
-            if (data.at(0) == MBUS_FRAME_ACK_START)
-            {
-                emit(newTreeAddress(adr));
-                QString adrStr = QString("%1").arg(adr);
-                if (!devices.contains(adrStr)) devices.append(adrStr);
-                mbus_setType(frame, MBUS_FRAME_TYPE_SHORT);
-                frame.control = MBUS_CONTROL_MASK_REQ_UD2 | MBUS_CONTROL_MASK_DIR_M2S; // data request from master to slave
-                frame.address = adr;
-                data.clear();
-                if (logEnabled) log += addTimeTag QString("Get device data");
-                get(Socket, frame, data, 1000);
-                mbus_frame_data frame_data;
-                if (!data.isEmpty())
-                {
-                    mbus_frame reply;
-                    mbus_parse(reply, data);
-                    if (logEnabled)
-                    {
-                        QString logtxt;
-                        for (unsigned int n=0; n<reply.data_size; n++) logtxt += QString("[%1]").arg((unsigned char)reply.data[n]);
-                        log += addTimeTag "Data after parsing : " + logtxt;
-                    }
-                    mbus_frame_data_parse(reply, frame_data, adr);
-                }
-                // DonnÃ©e instantanÃ©e
-                mbus_setType(frame, MBUS_FRAME_TYPE_CONTROL);
-                frame.control = MBUS_CONTROL_MASK_SND_UD;
-                frame.control_information = MBUS_CONTROL_INFO_REQUEST_RAM_READ;
-                frame.address = adr;
-                data.clear();
-                if (logEnabled) log += addTimeTag QString("Get device real time data");
-                get(Socket, frame, data, 1000);
-                if (!data.isEmpty())
-                {
-                    mbus_frame reply;
-                    //mbus_frame_data frame_data;
-                    if (mbus_parse(reply, data)) return;
-                    if (logEnabled)
-                    {
-                        QString logtxt;
-                        for (unsigned int n=0; n<reply.data_size; n++) logtxt += QString("[%1]").arg((unsigned char)reply.data[n]);
-                        log += addTimeTag "Real time data after parsing : " + logtxt;
-                    }
-                    mbus_frame_data_parse(reply, frame_data, adr);
-                }
-                for (int n=0; n<frame_data.data_var.records.count(); n++) delete frame_data.data_var.records.at(n);
-            }
-            else
-            {
-                if (logEnabled) log += addTimeTag "Unknown answer, may be data collision";
-            }
+            emit(newTreeAddress(adr));
+            addMeter(adr);
+        }
+        else
+        {
+            if (logEnabled) log += addTimeTag "Unknown answer, may be data collision";
         }
     }
 }
@@ -358,8 +452,6 @@ void mbusthread::searchMbus(QTcpSocket &Socket)
 
 
 
-
-
 int mbusthread::mbus_frame_pack(mbus_frame &frame, QByteArray &data)
 {
     size_t i; //, offset = 0;
@@ -502,53 +594,60 @@ quint8 mbusthread::calc_checksum(mbus_frame &frame)
 
 void mbusthread::get(QTcpSocket &Socket, mbus_frame &frame, QByteArray &Data, int timeout)
 {
-    if (Socket.state() == QAbstractSocket::ConnectedState)
+    QByteArray Request;
+    if (mbus_frame_pack(frame, Request) == -1) return;
+    QString logtxt;
+    if (logEnabled)
     {
-        QByteArray Request;
-        if (mbus_frame_pack(frame, Request) == -1) return;
-        QString logtxt;
         for (int n=0; n<Request.length(); n++) logtxt += QString("[%1]").arg((unsigned char)Request[n]);
-        if (logEnabled) log += addTimeTag "Request : " + logtxt;
-        if (Socket.isValid()) Socket.write(Request); else return;
-        if (Socket.waitForBytesWritten())
+        log += addTimeTag "Request : " + logtxt;
+    }
+    switch (link.request(Request, Data, timeout))
+    {
+        case bustransport::requestNotConnected :
         {
-            //msleep(200);
-            int d = 0;
-            while (Socket.waitForReadyRead(timeout))
-            {
-                d++;
-                Data.append(Socket.readAll());
-            }
-            if (d)
-            {
-                if (logEnabled)
-                {
-                    logtxt.clear();
-                    for (int n=0; n<Data.length(); n++) logtxt += QString("[%1]").arg((unsigned char)Data[n]);
-                    log += addTimeTag "Read Raw : " + logtxt;
-                }
-            }
-            else
+            QString msg = "Socket error before writing, reconnect, request = ";
+            TCPconnect(Socket, msg);
+        } break;
+        case bustransport::requestWriteError :
+            if (logEnabled) log += addTimeTag "Error writing data : ";
+            break;
+        case bustransport::requestTimeout :
+            if (logEnabled) log += addTimeTag "No Data";
+            break;
+        default :
+            if (logEnabled)
             {
-                    if (logEnabled) log += addTimeTag "No Data";
+                logtxt.clear();
+                for (int n=0; n<Data.length(); n++) logtxt += QString("[%1]").arg((unsigned char)Data[n]);
+                log += addTimeTag "Read Raw : " + logtxt;
             }
-        }
-        else
-        {
-            if (logEnabled) log += addTimeTag "Error writing data : ";
-        }
+            break;
     }
-    else
+}
+
+
+
+
+
+int mbusthread::frameLength(const QByteArray &data)
+{
+// Expected frame size from the bytes already received, 0 while unknown
+    if (data.isEmpty()) return 0;
+    switch (quint8(data.at(0)))
     {
-        QString msg = "Socket error before writing, reconnect, request = ";
-        TCPconnect(Socket, msg);
+        case quint8(MBUS_FRAME_ACK_START) : return MBUS_FRAME_BASE_SIZE_ACK;
+        case quint8(MBUS_FRAME_SHORT_START) : return MBUS_FRAME_BASE_SIZE_SHORT;
+        case quint8(MBUS_FRAME_LONG_START) :
+            if (data.length() < 2) return 0;
+            return quint8(data.at(1)) + MBUS_FRAME_FIXED_SIZE_LONG;
     }
+    return 0;
 }
 
 
 
 
-
 int mbusthread::mbus_parse(mbus_frame &frame, QByteArray &data)
 {
     if (logEnabled) log += addTimeTag "mbus_parse";
@@ -701,7 +800,6 @@ int mbusthread::mbus_frame_data_parse(mbus_frame &frame, mbus_frame_data &data,
     {
         data.type = MBUS_DATA_TYPE_VARIABLE;
         int r = mbus_data_variable_parse(frame, data.data_var, adr);
-        //for (int n=0; n<data.data_var.records.count(); n++) delete data.data_var.records.at(n);
         return r;
     }
     return -1;
@@ -763,11 +861,18 @@ void mbusthread::mbus_data_variable_print(mbus_data_variable &data, int adr)
 //	7Fh	Global readout request (all storage#, units, tariffs, function fields)
     for (int n=0; n<data.records.count(); n++)
     {
-        QString value = mbus_data_record_decode(data.records.at(n));
-        QString unit = mbus_vib_unit_lookup(data.records.at(n)->drh.vib);
-        QString comment = mbus_data_type(data.records.at(n)) + "  ";
-        for (unsigned int i=0; i<data.records.at(n)->data_len; i++) comment += QString("[%1]").arg((unsigned char)data.records.at(n)->data[i], 2, 16, QChar('0')).toUpper();
-        addTreeItem(adr, n, unit, value, comment, true);
+        static const char hexDigits[] = "0123456789ABCDEF";
+        const mbus_data_record &record = data.records.at(n);
+        QString comment = mbus_data_type(record) + "  ";
+        comment.reserve(comment.length() + int(record.data_len) * 4);
+        for (unsigned int i=0; i<record.data_len; i++)
+        {
+            comment += QLatin1Char('[');
+            comment += QLatin1Char(hexDigits[record.data[i] >> 4]);
+            comment += QLatin1Char(hexDigits[record.data[i] & 0x0F]);
+            comment += QLatin1Char(']');
+        }
+        addTreeItem(adr, n, mbus_vib_unit_lookup(record.drh.vib), mbus_data_record_decode(record), comment, true);
 
     /*	QString dif = QString("%1").arg(data.records.at(n)->drh.dib.dif, 2, 16, QChar('0')).toUpper();
         QString D = "DIF";
@@ -1026,9 +1131,9 @@ quint64 mbusthread::mbus_data_long_decode(quint8 *int_data, size_t int_data_size
 
 
 
-void mbusthread::mbus_data_str_decode(QString &dst, mbus_data_record *record)
+void mbusthread::mbus_data_str_decode(QString &dst, const mbus_data_record &record)
 {
-    for (quint16 n=0; n<record->data_len; n++) dst.append(QChar((char)record->data[n]));
+    for (quint16 n=0; n<record.data_len; n++) dst.append(QChar((char)record.data[n]));
 /*    size_t i;
     record->data
     i = 0;
@@ -1183,295 +1288,145 @@ QString mbusthread::mbus_unit_prefix(int exp)
 
 
 
-QString mbusthread::mbus_vif_unit_lookup(quint8 vif)
+// Unit names are built once from these tables, records only index them
+struct vifRange
+{
+    quint8 first;
+    quint8 last;
+    quint8 quantity;
+    qint8 exponent;     // exponent of the first code
+};
+
+static const vifRange vifRanges[] = {
+    { 0x00, 0x07, mbusthread::vifEnergyWh, -3 },            // E000 0nnn Energy 10(nnn-3) Wh
+    { 0x08, 0x0F, mbusthread::vifEnergyJ, 0 },              // E000 1nnn Energy 10(nnn) J
+    { 0x10, 0x17, mbusthread::vifVolume, -6 },              // E001 0nnn Volume 10(nnn-6) m3
+    { 0x18, 0x1F, mbusthread::vifMass, -3 },                // E001 1nnn Mass 10(nnn-3) kg
+    { 0x20, 0x23, mbusthread::vifOnTime, 0 },               // E010 00nn On Time s/mn/h/d
+    { 0x24, 0x27, mbusthread::vifOperatingTime, 0 },        // E010 01nn Operating Time s/mn/h/d
+    { 0x28, 0x2F, mbusthread::vifPowerW, -3 },              // E010 1nnn Power 10(nnn-3) W
+    { 0x30, 0x37, mbusthread::vifPowerJh, 0 },              // E011 0nnn Power 10(nnn) J/h
+    { 0x38, 0x3F, mbusthread::vifVolumeFlowH, -6 },         // E011 1nnn Volume Flow 10(nnn-6) m3/h
+    { 0x40, 0x47, mbusthread::vifVolumeFlowMin, -7 },       // E100 0nnn Volume Flow ext. 10(nnn-7) m3/min
+    { 0x48, 0x4F, mbusthread::vifVolumeFlowS, -9 },         // E100 1nnn Volume Flow ext. 10(nnn-9) m3/s
+    { 0x50, 0x57, mbusthread::vifMassFlow, -3 },            // E101 0nnn Mass flow 10(nnn-3) kg/h
+    { 0x58, 0x5B, mbusthread::vifFlowTemperature, -3 },     // E101 10nn Flow Temperature 10(nn-3) deg C
+    { 0x5C, 0x5F, mbusthread::vifReturnTemperature, -3 },   // E101 11nn Return Temperature 10(nn-3) deg C
+    { 0x60, 0x63, mbusthread::vifTemperatureDiff, -3 },     // E110 00nn Temperature Difference 10(nn-3) K
+    { 0x64, 0x67, mbusthread::vifExternalTemperature, -3 }, // E110 01nn External Temperature 10(nn-3) deg C
+    { 0x68, 0x6B, mbusthread::vifPressure, -3 },            // E110 10nn Pressure 10(nn-3) bar
+    { 0x6C, 0x6D, mbusthread::vifTimePoint, 0 },            // E110 110n Time Point date / time & date
+    { 0x6E, 0x6E, mbusthread::vifHCA, 0 },                  // E110 1110 Units for H.C.A.
+    { 0x6F, 0x6F, mbusthread::vifReserved, 0 },             // E110 1111 Reserved
+    { 0x78, 0x78, mbusthread::vifFabricationNo, 0 },
+    { 0x7C, 0x7C, mbusthread::vifCustom, 0 },
+    { 0x7F, 0x7F, mbusthread::vifManufacturer, 0 },
+    { 0xFF, 0xFF, mbusthread::vifManufacturer, 0 } };
+
+static const char *vifFormats[mbusthread::vifQuantityCount] = {
+    "", "Energy (%1Wh)", "Energy (%1J)", "Volume (%1m^3)", "Mass (%1kg)", "On time %1", "Operating time %1", "Power (%1W)",
+    "Power (%1J/h)", "Volume flow (%1m^3/h)", "Volume (%1m^3/min)", "Volume (%1m^3/s)", "Mass flow  (%1kg/h)",
+    "Flow temperature (%1deg C)", "Return temperature (%1deg C)", "Temperature Difference (%1deg C)",
+    "External temperature (%1deg C)", "Pressure (%1bar)", "Time Point %1", "Units for H.C.A.", "Reserved",
+    "Fabrication number", "Custom VIF", "Fabrication specific", "", "%1 V", "%1 A" };
+
+static const char *timeUnits[] = { "(seconds)", "(minutes)", "(hours)", "(days)" };
+
+// VIFE following VIF = FDh, see table 8.4.4
+struct vifeLabel
 {
-    int n;
-    QString str;
-    switch (vif)
+    quint8 code;
+    const char *name;
+};
+
+static const vifeLabel vifeLabels[] = {
+    { 0x08, "Access Number (transmission count)" }, { 0x09, "Medium (as in fixed header)" },
+    { 0x0A, "Manufacturer (as in fixed header)" }, { 0x0B, "Parameter set identification" },
+    { 0x0C, "Model / Version" }, { 0x0D, "Hardware version" }, { 0x0E, "Firmware version" }, { 0x0F, "Software version" },
+    { 0x88, "Access Number (transmission count)" }, { 0x89, "Medium (as in fixed header)" },
+    { 0x8A, "Manufacturer (as in fixed header)" }, { 0x8B, "Parameter set identification" },
+    { 0x8C, "Model / Version" }, { 0x8D, "Hardware version" }, { 0x8E, "Firmware version" }, { 0x8F, "Software version" },
+    { 0x10, "Customer location" }, { 0x11, "Customer" }, { 0x16, "Password" }, { 0x17, "Error flags" }, { 0x97, "Error flags" },
+    { 0x1A, "Digital output (binary)" }, { 0x1B, "Digital input (binary)" } };
+
+struct vifTables
+{
+    quint8 quantity[256];
+    qint8 exponent[256];
+    QString vifName[256];
+    QString vifeName[256];
+    vifTables()
     {
-        // E000 0nnn Energy 10(nnn-3) W
-        case 0x00:
-        case 0x00+1:
-        case 0x00+2:
-        case 0x00+3:
-        case 0x00+4:
-        case 0x00+5:
-        case 0x00+6:
-        case 0x00+7:
-            n = (vif & 0x07) - 3;
-            str = "Energy (" + mbus_unit_prefix(n) + "Wh)";
-            break;
-        // 0000 1nnn          Energy       10(nnn)J     (0.001kJ to 10000kJ)
-        case 0x08:
-        case 0x08+1:
-        case 0x08+2:
-        case 0x08+3:
-        case 0x08+4:
-        case 0x08+5:
-        case 0x08+6:
-        case 0x08+7:
-            n = (vif & 0x07);
-            str = "Energy (" + mbus_unit_prefix(n) + "J)";
-            break;
-        // E001 1nnn Mass 10(nnn-3) kg 0.001kg to 10000kg
-        case 0x18:
-        case 0x18+1:
-        case 0x18+2:
-        case 0x18+3:
-        case 0x18+4:
-        case 0x18+5:
-        case 0x18+6:
-        case 0x18+7:
-            n = (vif & 0x07);
-            str = "Mass (" + mbus_unit_prefix(n-3) + "kg)";
-            break;
-        // E010 1nnn Power 10(nnn-3) W 0.001W to 10000W
-        case 0x28:
-        case 0x28+1:
-        case 0x28+2:
-        case 0x28+3:
-        case 0x28+4:
-        case 0x28+5:
-        case 0x28+6:
-        case 0x28+7:
-            n = (vif & 0x07);
-            str = "Power (" + mbus_unit_prefix(n-3) + "W)";
-            break;
-            // E011 0nnn Power 10(nnn) J/h 0.001kJ/h to 10000kJ/h
-        case 0x30:
-        case 0x30+1:
-        case 0x30+2:
-        case 0x30+3:
-        case 0x30+4:
-        case 0x30+5:
-        case 0x30+6:
-        case 0x30+7:
-            n = (vif & 0x07);
-            str = "Power (" + mbus_unit_prefix(n) + "J/h)";
-            break;
-        // E001 0nnn Volume 10(nnn-6) m3 0.001l to 10000l
-        case 0x10:
-        case 0x10+1:
-        case 0x10+2:
-        case 0x10+3:
-        case 0x10+4:
-        case 0x10+5:
-        case 0x10+6:
-        case 0x10+7:
-            n = (vif & 0x07);
-            str = "Volume (" + mbus_unit_prefix(n-6) + "m^3)";
-            break;
-        // E011 1nnn Volume Flow 10(nnn-6) m3/h 0.001l/h to 10000l/
-        case 0x38:
-        case 0x38+1:
-        case 0x38+2:
-        case 0x38+3:
-        case 0x38+4:
-        case 0x38+5:
-        case 0x38+6:
-        case 0x38+7:
-            n = (vif & 0x07);
-            str = "Volume flow (" + mbus_unit_prefix(n-6) + "m^3/h)";
-            break;
-        // E100 0nnn Volume Flow ext. 10(nnn-7) m3/min 0.0001l/min to 1000l/min
-        case 0x40:
-        case 0x40+1:
-        case 0x40+2:
-        case 0x40+3:
-        case 0x40+4:
-        case 0x40+5:
-        case 0x40+6:
-        case 0x40+7:
-            n = (vif & 0x07);
-            str = "Volume (" + mbus_unit_prefix(n-7) + "m^3/min)";
-            break;
-        // E100 1nnn Volume Flow ext. 10(nnn-9) m3/s 0.001ml/s to 10000ml/
-        case 0x48:
-        case 0x48+1:
-        case 0x48+2:
-        case 0x48+3:
-        case 0x48+4:
-        case 0x48+5:
-        case 0x48+6:
-        case 0x48+7:
-            n = (vif & 0x07);
-            str = "Volume (" + mbus_unit_prefix(n-9) + "m^3/s)";
-            break;
-        // E101 0nnn Mass flow 10(nnn-3) kg/h 0.001kg/h to 10000kg/
-        case 0x50:
-        case 0x50+1:
-        case 0x50+2:
-        case 0x50+3:
-        case 0x50+4:
-        case 0x50+5:
-        case 0x50+6:
-        case 0x50+7:
-            n = (vif & 0x07);
-            str = "Mass flow  (" + mbus_unit_prefix(n-3) + "kg/h)";
-            break;
-        // E101 10nn Flow Temperature 10(nn-3) Â°C 0.001Â°C to 1Â°C
-        case 0x58:
-        case 0x58+1:
-        case 0x58+2:
-        case 0x58+3:
-            n = (vif & 0x03);
-            str = "Flow temperature (" + mbus_unit_prefix(n-3) + "deg C)";
-            break;
-        // E101 11nn Return Temperature 10(nn-3) Â°C 0.001Â°C to 1Â°C
-        case 0x5C:
-        case 0x5C+1:
-        case 0x5C+2:
-        case 0x5C+3:
-            n = (vif & 0x03);
-            str = "Return temperature (" + mbus_unit_prefix(n-3) + "deg C)";
-            break;
-        // E110 10nn Pressure 10(nn-3) bar 1mbar to 1000mbar
-        case 0x68:
-        case 0x68+1:
-        case 0x68+2:
-        case 0x68+3:
-            n = (vif & 0x03);
-            str = "Pressure (" + mbus_unit_prefix(n-3) + "bar)";
-            break;
-        // E010 00nn On Time
-        // nn = 00 seconds
-        // nn = 01 minutes
-        // nn = 10   hours
-        // nn = 11    days
-        // E010 01nn Operating Time coded like OnTime
-        case 0x20:
-        case 0x20+1:
-        case 0x20+2:
-        case 0x20+3:
-        case 0x24:
-        case 0x24+1:
-        case 0x24+2:
-        case 0x24+3:
+        for (int vif=0; vif<256; vif++)
+        {
+            quantity[vif] = mbusthread::vifUnknown;
+            exponent[vif] = 0;
+        }
+        for (unsigned int n=0; n<sizeof(vifRanges)/sizeof(vifRanges[0]); n++)
+            for (int vif=vifRanges[n].first; vif<=vifRanges[n].last; vif++)
             {
-                if (vif & 0x4) str += "Operating time ";
-                else str += "On time ";
-                switch (vif & 0x03)
-                {
-                    case 0x00: str += "(seconds)"; break;
-                    case 0x01: str += "(minutes)"; break;
-                    case 0x02: str += "(hours)"; break;
-                    case 0x03: str += "(days)"; break;
-                }
+                quantity[vif] = vifRanges[n].quantity;
+                exponent[vif] = qint8(vifRanges[n].exponent + vif - vifRanges[n].first);
             }
-            break;
+        for (int vif=0; vif<256; vif++)
+        {
+            QString format = vifFormats[quantity[vif]];
+            switch (quantity[vif])
+            {
+                case mbusthread::vifUnknown : vifName[vif] = mbusthread::tr("Unknown VIF") + QString(" 0x%1").arg(vif, 2, 16, QChar('0')).toUpper(); break;
+                case mbusthread::vifOnTime :
+                case mbusthread::vifOperatingTime : vifName[vif] = format.arg(QString(timeUnits[exponent[vif]])); break;
+                case mbusthread::vifTimePoint : vifName[vif] = format.arg(QString(exponent[vif] ? "(time & date)" : "(date)")); break;
+                default : vifName[vif] = format.contains("%1") ? format.arg(mbusthread::mbus_unit_prefix(exponent[vif])) : format; break;
+            }
+        }
+        for (int vife=0; vife<256; vife++)
+        {
+            if ((vife & 0x70) == 0x40)
+            {
+                // VIFE = E100 nnnn 10^(nnnn-9) V
+                vifeName[vife] = QString(vifFormats[mbusthread::vifVoltage]).arg(mbusthread::mbus_unit_prefix((vife & 0x0F) - 9));
+            }
+            else if ((vife & 0x70) == 0x50)
+            {
+                // VIFE = E101 nnnn 10^(nnnn-12) A
+                vifeName[vife] = QString(vifFormats[mbusthread::vifCurrent]).arg(mbusthread::mbus_unit_prefix((vife & 0x0F) - 12));
+            }
+            else if ((vife & 0xF0) == 0x70) vifeName[vife] = "Reserved VIF extension";
+            else vifeName[vife] = QString("Unrecongized VIF extension: %1").arg(vife);
+        }
+        for (unsigned int n=0; n<sizeof(vifeLabels)/sizeof(vifeLabels[0]); n++) vifeName[vifeLabels[n].code] = vifeLabels[n].name;
+    }
+    static const vifTables &get()
+    {
+        static const vifTables tables;
+        return tables;
+    }
+};
 
-        // E110 110n Time Point
-        // n = 0        date
-        // n = 1 time & date
-        // data type G
-        // data type F
-        case 0x6C:
-        case 0x6C+1:
 
-            if (vif & 0x1) str = "Time Point (time & date)";
-            else str = "Time Point (date)";
-            break;
-            // E110 00nn    Temperature Difference   10(nn-3)K   (mK to  K)
-        case 0x60:
-        case 0x60+1:
-        case 0x60+2:
-        case 0x60+3:
-            n = (vif & 0x03);
-            str = "Temperature Difference (" + mbus_unit_prefix(n-3) + "deg C)";
-            break;
-        // E110 01nn External Temperature 10(nn-3) Â°C 0.001Â°C to 1Â°C
-        case 0x64:
-        case 0x64+1:
-        case 0x64+2:
-        case 0x64+3:
-            n = (vif & 0x03);
-            str = "External temperature (" + mbus_unit_prefix(n-3) + "deg C)";
-            break;
-        // E110 1110 Units for H.C.A. dimensionless
-        case 0x6E:
-            str = "Units for H.C.A.";
-            break;
-        // E110 1111 Reserved
-        case 0x6F:
-            str = "Reserved";
-            break;
-        // Custom VIF
-        case 0x7C:
-            str = "Custom VIF";
-            break;
-        // Fabrication No
-        case 0x78:
-            str = "Fabrication number";
-            break;
-        // Manufacturer specific: 7Fh / FF
-        case 0x7F:
-        case 0xFF:
-            str = "Fabrication specific";
-            break;
-        default:
-            str = tr("Unknown VIF") + QString(" 0x%1").arg(vif, 2, 16, QChar('0')).toUpper();
-            break;
-    }
-    return str;
+
+
+QString mbusthread::mbus_vif_unit_lookup(quint8 vif)
+{
+    return vifTables::get().vifName[vif];
 }
 
 
 
 
 
-QString mbusthread::mbus_data_type(mbus_data_record *record)
+QString mbusthread::mbus_data_type(const mbus_data_record &record)
 {
-    QString str;
-    int dif = record->drh.dib.dif & 0x0F;
-    switch (dif)
-    {
-        case 0x00: // no data	break;
-        case 0x01: // 1 byte integer (8 bit)
-            str = "1 byte integer (8 bit)";
-            break;
-        case 0x02: // 2 byte integer (16 bit)
-            str = "2 byte integer (16 bit)";
-            break;
-        case 0x03: // 3 byte integer (24 bit)
-            str = "3 byte integer (24 bit)";
-            break;
-        case 0x04: // 4 byte integer (32 bit)
-            str = "4 byte integer (32 bit)";
-            break;
-        case 0x05: // 4 byte real (32 bit)
-            str = "4 byte real (32 bit)";
-            break;
-        case 0x06: // 6 byte integer (48 bit)
-            str = "6 byte integer (48 bit)";
-            break;
-        case 0x07: // 8 byte integer (64 bit)
-            str = "8 byte integer (64 bit)";
-            break;
-        case 0x09: // 2 digit BCD (8 bit)
-            str = "2 digit BCD (8 bit)";
-            break;
-        case 0x0A: // 4 digit BCD (16 bit)
-            str = "4 digit BCD (16 bit)";
-            break;
-        case 0x0B: // 6 digit BCD (24 bit)
-            str = "6 digit BCD (24 bit)";
-            break;
-        case 0x0C: // 8 digit BCD (32 bit)
-            str = "8 digit BCD (32 bit)";
-            break;
-        case 0x0D: // variable length
-            str = "Variable length";
-            break;
-        case 0x0E: // 12 digit BCD (48 bit)
-            str = "12 digit BCD (48 bit)";
-            break;
-        case 0x0F: // special functions
-            str = "Special functions";
-            break;
-        default : str = tr("Unknown DIF") + QString(" 0x%1").arg(record->drh.dib.dif & 0x0F, 2, 16, QChar('0')).toUpper();
-            break;
-        }
-    return str;
+// DIF 0 (no data) has always been shown as an 8 bit integer
+    static const char *types[16] = {
+        "1 byte integer (8 bit)", "1 byte integer (8 bit)", "2 byte integer (16 bit)", "3 byte integer (24 bit)",
+        "4 byte integer (32 bit)", "4 byte real (32 bit)", "6 byte integer (48 bit)", "8 byte integer (64 bit)",
+        nullptr, "2 digit BCD (8 bit)", "4 digit BCD (16 bit)", "6 digit BCD (24 bit)",
+        "8 digit BCD (32 bit)", "Variable length", "12 digit BCD (48 bit)", "Special functions" };
+    int dif = record.drh.dib.dif & 0x0F;
+    if (types[dif]) return types[dif];
+    return tr("Unknown DIF") + QString(" 0x%1").arg(dif, 2, 16, QChar('0')).toUpper();
 }
 
 
@@ -1506,179 +1461,85 @@ void mbusthread::mbus_data_str_type(QString &dst, const quint8 *src)
 
 
 
-QString mbusthread::mbus_data_record_decode(mbus_data_record *record)
+void mbusthread::mbus_data_record_value(mbus_data_record &record)
 {
-    QString str;
-    int dif = record->drh.dib.dif & 0x0F;
+// Numeric decoding, strings are only made by mbus_data_record_decode
+    record.kind = recordNone;
+    record.integer = 0;
+    record.real = 0;
+    int dif = record.drh.dib.dif & 0x0F;
     switch (dif)
     {
-        case 0x00: // no data	break;
         case 0x01: // 1 byte integer (8 bit)
-            str = QString("%1").arg(mbus_data_int_decode(record->data, 1));
-            break;
         case 0x02: // 2 byte integer (16 bit)
-            str = QString("%1   ").arg(mbus_data_int_decode(record->data, 2));
-            //str += mbus_data_G_Format(record->data).toString("dd-MM-yyyy");
-            break;
         case 0x03: // 3 byte integer (24 bit)
-            str = QString("%1").arg(mbus_data_int_decode(record->data, 3));
-            break;
         case 0x04: // 4 byte integer (32 bit)
-            str = QString("%1   ").arg(mbus_data_int_decode(record->data, 4));
-            //str += mbus_data_F_Format(record->data).toString("dd-MM-yyyy hh:mm");
+            record.kind = recordInteger;
+            record.integer = mbus_data_int_decode(record.data, size_t(dif));
+            record.real = qreal(record.integer);
             break;
         case 0x05: // 4 byte real (32 bit)
-            str = QString("%1   ").arg(mbus_data_float_decode(record->data, 4));
-            //str += mbus_data_F_Format(record->data).toString("dd-MM-yyyy hh:mm");
+            record.kind = recordReal;
+            record.real = mbus_data_float_decode(record.data, 4);
             break;
         case 0x06: // 6 byte integer (48 bit)
-            str = QString("%1").arg(mbus_data_long_decode(record->data, 6));
-            break;
         case 0x07: // 8 byte integer (64 bit)
-            str = QString("%1").arg(mbus_data_long_decode(record->data, 8));
+            record.kind = recordUnsigned;
+            record.integer = qint64(mbus_data_long_decode(record.data, (dif == 0x06) ? 6 : 8));
+            record.real = qreal(quint64(record.integer));
             break;
         case 0x09: // 2 digit BCD (8 bit)
-            str = QString("%1").arg(mbus_data_bcd_decode(record->data, 1));
-            break;
         case 0x0A: // 4 digit BCD (16 bit)
-            str = QString("%1").arg(mbus_data_bcd_decode(record->data, 2));
-            break;
         case 0x0B: // 6 digit BCD (24 bit)
-            str = QString("%1").arg(mbus_data_bcd_decode(record->data, 3));
-            break;
         case 0x0C: // 8 digit BCD (32 bit)
-            str = QString("%1").arg(mbus_data_bcd_decode(record->data, 4));
-            break;
-        case 0x0D: // variable length
-            if(record->data_len <= 0xBF) mbus_data_str_decode(str, record);
-            break;
         case 0x0E: // 12 digit BCD (48 bit)
-            str = QString("%1").arg(mbus_data_bcd_decode(record->data, 6));
-           break;
-        case 0x0F: // special functions
-            //mbus_data_bin_decode(buff, record->data, record->data_len, sizeof(buff));
+            record.kind = recordBCD;
+            record.integer = mbus_data_bcd_decode(record.data, (dif == 0x0E) ? 6 : size_t(dif - 0x08));
+            record.real = qreal(record.integer);
             break;
-        default: str = tr("Unknown DIF") + QString(" 0x%1").arg(record->drh.dib.dif & 0x0F, 2, 16, QChar('0')).toUpper();
+        case 0x0D: // variable length
+            if (record.data_len <= 0xBF) record.kind = recordText;
             break;
     }
-    return str;
 }
 
 
 
-QString mbusthread::mbus_vib_unit_lookup(mbus_value_information_block &vib)
+
+QString mbusthread::mbus_data_record_decode(const mbus_data_record &record)
 {
-    QString str;
-    if (vib.vif == (quint8)0xFD) // first type of VIF extention: see table 8.4.4
+    int dif = record.drh.dib.dif & 0x0F;
+    switch (record.kind)
     {
-        if (vib.nvife == 0) str = "Missing VIF extension";
-        else if (vib.vife[0] == 0x08 || vib.vife[0] == 0x88)
-        {
-            // E000 1000
-            str = "Access Number (transmission count)";
-        }
-        else if (vib.vife[0] == 0x09|| vib.vife[0] == 0x89)
-        {
-            // E000 1001
-            str = "Medium (as in fixed header)";
-        }
-        else if (vib.vife[0] == 0x0A || vib.vife[0] == 0x8A)
-        {
-            // E000 1010
-            str = "Manufacturer (as in fixed header)";
-        }
-        else if (vib.vife[0] == 0x0B || vib.vife[0] == 0x8B)
-        {
-            // E000 1010
-            str = "Parameter set identification";
-        }
-        else if (vib.vife[0] == 0x0C || vib.vife[0] == 0x8C)
-        {
-            // E000 1100
-            str = "Model / Version";
-        }
-        else if (vib.vife[0] == 0x0D || vib.vife[0] == 0x8D)
-        {
-            // E000 1100
-            str = "Hardware version";
-        }
-        else if (vib.vife[0] == 0x0E || vib.vife[0] == 0x8E)
-        {
-            // E000 1101
-            str = "Firmware version";
-        }
-        else if (vib.vife[0] == 0x0F || vib.vife[0] == 0x8F)
-        {
-            // E000 1101
-            str = "Software version";
-        }
-        else if (vib.vife[0] == 0x10)
-        {
-            // VIFE = E001 0000 Customer location
-            str = "Customer location";
-        }
-        else if (vib.vife[0] == 0x11)
-        {
-            // VIFE = E001 0001 Customer
-            str = "Customer";
-        }
-        else if (vib.vife[0] == 0x16)
-        {
-            // VIFE = E001 0110 Password
-            str = "Password";
-        }
-        else if (vib.vife[0] == 0x17 || vib.vife[0] == 0x97)
-        {
-            // VIFE = E001 0111 Error flags
-            str = "Error flags";
-        }
-        else if (vib.vife[0] == 0x1A)
-        {
-            // VIFE = E001 1010 Digital output (binary)
-            str = "Digital output (binary)";
-        }
-        else if (vib.vife[0] == 0x1B)
-        {
-            // VIFE = E001 1011 Digital input (binary)
-            str = "Digital input (binary)";
-        }
-        else if ((vib.vife[0] & 0x70) == 0x40)
-        {
-            // VIFE = E100 nnnn 10^(nnnn-9) V
-            int n = (vib.vife[0] & 0x0F);
-            str = QString("%1 V").arg(mbus_unit_prefix(n-9));
-        }
-        else if ((vib.vife[0] & 0x70) == 0x50)
-        {
-            // VIFE = E101 nnnn 10nnnn-12 A
-            int n = (vib.vife[0] & 0x0F);
-            str = QString("%1 A").arg(mbus_unit_prefix(n-12));
-        }
-        else if ((vib.vife[0] & 0xF0) == 0x70)
+        case recordInteger:
+            if ((dif == 0x02) || (dif == 0x04)) return QString("%1   ").arg(quint32(record.integer));
+            return QString("%1").arg(quint32(record.integer));
+        case recordReal: return QString("%1   ").arg(record.real);
+        case recordUnsigned: return QString("%1").arg(quint64(record.integer));
+        case recordBCD: return QString("%1").arg(qint32(record.integer));
+        case recordText:
         {
-            // VIFE = E111 nnn Reserved
-            str = "Reserved VIF extension";
+            QString str;
+            mbus_data_str_decode(str, record);
+            return str;
         }
-        else
-        {
-            str = QString("Unrecongized VIF extension: %1").arg(vib.vife[0]);
-        }
-        return str;
-    }
-    else if (vib.vif == 0x7C)
-    {
-        // custom VIF
-        //str = QString("%1").arg(vib.custom_vif);
-        return str;
     }
-    else if (vib.vif == 0xFC && (vib.vife[0] & 0x78) == 0x70)
+    if (dif == 0x08) return tr("Unknown DIF") + QString(" 0x%1").arg(dif, 2, 16, QChar('0')).toUpper();
+    return QString();
+}
+
+
+
+QString mbusthread::mbus_vib_unit_lookup(const mbus_value_information_block &vib)
+{
+    if (vib.vif == quint8(0xFD)) // first type of VIF extention: see table 8.4.4
     {
-        // custom VIF
-        //int n = (vib.vife[0] & 0x07);
-        //str = QString("%1 %2").arg(mbus_unit_prefix(n-6)).arg(vib.custom_vif);
-        return str;
+        if (vib.nvife == 0) return "Missing VIF extension";
+        return vifTables::get().vifeName[vib.vife[0]];
     }
-    return mbus_vif_unit_lookup(vib.vif); // no extention, use VIF
+    if (vib.vif == 0x7C) return QString(); // custom VIF
+    if ((vib.vif == 0xFC) && ((vib.vife[0] & 0x78) == 0x70)) return QString(); // custom VIF
+    return vifTables::get().vifName[vib.vif]; // no extention, use VIF
 }
 
 
@@ -1784,52 +1645,34 @@ int mbusthread::mbus_data_variable_parse(mbus_frame &frame, mbus_data_variable &
     data.header.signature[0]    = frame.data[10];
     data.header.signature[1]    = frame.data[11];
 
+    mbus_data_record record;
     while (i < frame.data_size)
     {
-        mbus_data_record *record = new mbus_data_record;
         // Skip filler dif=2F
         if ((frame.data[i] & 0xFF) == MBUS_DIB_DIF_IDLE_FILLER)
         {
           i++;
           continue;
         }
-        if (record == nullptr)
-        {
-            if (logEnabled) log += addTimeTag "record == NULL";
-            return (-2);
-        }
 // read and parse DIB
         // DIF
-        record->drh.dib.dif = frame.data[i];
-        if ((record->drh.dib.dif == MBUS_DIB_DIF_MANUFACTURER_SPECIFIC) || (record->drh.dib.dif == MBUS_DIB_DIF_MORE_RECORDS_FOLLOW))
-        {
-            i++;
-            //log += addTimeTag QString("i++ DIF");
-            // just copy the remaining data as it is vendor specific
-            record->data_len = frame.data_size - i;
-            for (j=0; j<record->data_len; j++)
-            {
-                record->data[j] = frame.data[i++];
-                //log += addTimeTag QString("i++ record->data[j]");
-            }
-            // append the record and move on to next one
-            //data.records.append(record);
-            continue;
-        }
+        record.drh.dib.dif = frame.data[i];
+        // remaining data is vendor specific and never shown
+        if ((record.drh.dib.dif == MBUS_DIB_DIF_MANUFACTURER_SPECIFIC) || (record.drh.dib.dif == MBUS_DIB_DIF_MORE_RECORDS_FOLLOW)) break;
         // calculate length of data record
-        record->data_len = mbus_dif_datalength_lookup(record->drh.dib.dif);
+        record.data_len = mbus_dif_datalength_lookup(record.drh.dib.dif);
 
-        //log += addTimeTag QString("record->data_len %1").arg(record->data_len);
+        //log += addTimeTag QString("record.data_len %1").arg(record.data_len);
         // read DIF extensions
-        record->drh.dib.ndife = 0;
+        record.drh.dib.ndife = 0;
 
-       while ((frame.data[i] & MBUS_DIB_DIF_EXTENSION_BIT) && (record->drh.dib.ndife < NITEMS(record->drh.dib.dife)))
-        //while ((frame.data[i] & MBUS_DIB_DIF_EXTENSION_BIT) && record->drh.dib.ndife < difeMax)
+       while ((frame.data[i] & MBUS_DIB_DIF_EXTENSION_BIT) && (record.drh.dib.ndife < NITEMS(record.drh.dib.dife)))
+        //while ((frame.data[i] & MBUS_DIB_DIF_EXTENSION_BIT) && record.drh.dib.ndife < difeMax)
         {
             //log += addTimeTag QString("Extension bit found, frame.data[i] = %1").arg(frame.data[i]);
             quint8 dife = frame.data[i+1];
-            record->drh.dib.dife[record->drh.dib.ndife] = dife;
-            record->drh.dib.ndife++;
+            record.drh.dib.dife[record.drh.dib.ndife] = dife;
+            record.drh.dib.ndife++;
             i++;
             //log += addTimeTag QString("i++ MBUS_DIB_DIF_EXTENSION_BIT");
         }
@@ -1837,16 +1680,16 @@ int mbusthread::mbus_data_variable_parse(mbus_frame &frame, mbus_data_variable &
         //log += addTimeTag QString("i++ tout seul");
 
         // VIF
-        record->drh.vib.vif = frame.data[i];
+        record.drh.vib.vif = frame.data[i];
         //log += addTimeTag QString("i++ VIF");
         // VIFE
-        record->drh.vib.nvife = 0;
-        //while ((frame.data[i] & MBUS_DIB_VIF_EXTENSION_BIT) && (record->drh.vib.nvife < vifeMax))
-        while ((frame.data[i] & MBUS_DIB_VIF_EXTENSION_BIT) && (record->drh.vib.nvife < NITEMS(record->drh.vib.vife)))
+        record.drh.vib.nvife = 0;
+        //while ((frame.data[i] & MBUS_DIB_VIF_EXTENSION_BIT) && (record.drh.vib.nvife < vifeMax))
+        while ((frame.data[i] & MBUS_DIB_VIF_EXTENSION_BIT) && (record.drh.vib.nvife < NITEMS(record.drh.vib.vife)))
           {
             quint8 vife = frame.data[i+1];
-            record->drh.vib.vife[record->drh.vib.nvife] = vife;
-            record->drh.vib.nvife++;
+            record.drh.vib.vife[record.drh.vib.nvife] = vife;
+            record.drh.vib.nvife++;
             i++;
             //log += addTimeTag QString("i++ VIFE");
         }
@@ -1858,40 +1701,46 @@ int mbusthread::mbus_data_variable_parse(mbus_frame &frame, mbus_data_variable &
             //return -1;
         //}
         // calculate data variable length
-        if((record->drh.dib.dif & 0x0D) == 0x0D)
+        if((record.drh.dib.dif & 0x0D) == 0x0D)
         {
             if (frame.data[i] <= (quint8)0xBF)
             {
-                record->data_len = frame.data[i++];
+                record.data_len = frame.data[i++];
                 //log += addTimeTag QString("i++ 1");
             }
             else if ((frame.data[i] >= (quint8)0xC0) && (frame.data[i] <= (quint8)0xCF))
             {
-                record->data_len = (frame.data[i++] - 0xC0) * 2;
+                record.data_len = (frame.data[i++] - 0xC0) * 2;
                 //log += addTimeTag QString("i++ 2");
             }
             else if ((frame.data[i] >= (quint8)0xD0) && (frame.data[i] <= (quint8)0xDF))
             {
-                record->data_len = (frame.data[i++] - 0xD0) * 2;
+                record.data_len = (frame.data[i++] - 0xD0) * 2;
                 //log += addTimeTag QString("i++ 3");
             }
             else if ((frame.data[i] >= (quint8)0xE0) && (frame.data[i] <= (quint8)0xEF))
             {
-                record->data_len = frame.data[i++] - 0xE0;
+                record.data_len = frame.data[i++] - 0xE0;
                 //log += addTimeTag QString("i++ 4");
             }
             else if ((frame.data[i] >= (quint8)0xF0) && (frame.data[i] <= (quint8)0xFA))
             {
-                record->data_len = frame.data[i++] - (quint8)0xF0;
+                record.data_len = frame.data[i++] - (quint8)0xF0;
                 //log += addTimeTag QString("i++ 5");
             }
         }
         // copy data
-        for (j=0; j<record->data_len; j++)
+        if ((i + record.data_len > frame.data_size) || (record.data_len > sizeof(record.data)))
+        {
+            if (logEnabled) log += addTimeTag QString("Premature end of record %1").arg(data.records.count());
+            break;
+        }
+        for (j=0; j<record.data_len; j++)
         {
             //log += addTimeTag QString("Copy data %1 = %2").arg(j).arg(frame.data[i]);
-            record->data[j] = frame.data[i++];
+            record.data[j] = frame.data[i++];
         }
+        mbus_data_record_value(record);
         // append the record and move on to next one
         data.records.append(record);
     }
@@ -1904,94 +1753,17 @@ int mbusthread::mbus_data_variable_parse(mbus_frame &frame, mbus_data_variable &
 
 unsigned char mbusthread::mbus_dif_datalength_lookup(unsigned char dif)
 {
-    switch (dif & MBUS_DATA_RECORD_DIF_MASK_DATA)
-    {
-        case 0x0:
-            return 0;
-        case 0x1:
-            return 1;
-        case 0x2:
-            return 2;
-        case 0x3:
-            return 3;
-        case 0x4:
-            return 4;
-        case 0x5:
-            return 4;
-        case 0x6:
-            return 6;
-        case 0x7:
-            return 8;
-
-        case 0x8:
-            return 0;
-        case 0x9:
-            return 1;
-        case 0xA:
-            return 2;
-        case 0xB:
-            return 3;
-        case 0xC:
-            return 4;
-        case 0xD:
-            // variable data length,
-            // data length stored in data field
-            return 0;
-        case 0xE:
-            return 6;
-        case 0xF:
-            return 8;
-
-        default: // never reached
-            return 0x00;
-
-    }
+// 0xD : variable data length stored in data field
+    static const unsigned char lengths[16] = { 0, 1, 2, 3, 4, 4, 6, 8, 0, 1, 2, 3, 4, 0, 6, 8 };
+    return lengths[dif & MBUS_DATA_RECORD_DIF_MASK_DATA];
 }
 
 
 
 
-void mbusthread::TCPconnect(QTcpSocket &Socket, QString &Status)
+void mbusthread::TCPconnect(QTcpSocket &, QString &Status)
 {
-    if (logEnabled) log += addTimeTag "TCP Connect  " + Status;
-    int tryConnect = 1;
-    do
-    {
-        if (logEnabled) log += addTimeTag QString("TCP try connect %1").arg(tryConnect);
-        if (Socket.state() == QAbstractSocket::ConnectedState)
-        {
-            Socket.disconnectFromHost();
-            if (logEnabled) log += addTimeTag "Try Disconnect";
-            if (Socket.state() == QAbstractSocket::ConnectedState) Socket.waitForDisconnected();
-            if (Socket.state() != QAbstractSocket::ConnectedState)
-            {
-                if (logEnabled) log += addTimeTag "Socket disconnected";
-                tcpStatus = Socket.state();
-                emit(tcpStatusChange());
-            }
-            else
-            {
-                if (logEnabled) log += addTimeTag "Socket failed to disconnect";
-            }
-        }
-        else
-        {
-            if (logEnabled) log += addTimeTag "Socket not connected";
-        }
-        tcpStatus = Socket.state();
-        emit(tcpStatusChange());
-        Socket.connectToHost(moduleipaddress, port);
-        if (logEnabled) log += addTimeTag "Try Connect";
-        Socket.waitForConnected();
-        if (Socket.state() == QAbstractSocket::ConnectedState)
-        {
-            if (logEnabled) log += addTimeTag "Connect OK";
-        }
-        tcpStatus = Socket.state();
-        emit(tcpStatusChange());
-        tryConnect ++;
-    }
-    while (Socket.state() != QAbstractSocket::ConnectedState);
+    link.connectLink(moduleipaddress, port, Status);
 }
 
 
@@ -26,11 +26,18 @@
 #include <QtCore>
 #include <QThread>
 #include <QTcpSocket>
+#include "bustransport.h"
 
 class mbusthread : public QThread
 {
     Q_OBJECT
+    friend struct vifTables;
 public:
+enum recordKind { recordNone, recordInteger, recordUnsigned, recordReal, recordBCD, recordText };
+enum vifQuantity { vifUnknown, vifEnergyWh, vifEnergyJ, vifVolume, vifMass, vifOnTime, vifOperatingTime, vifPowerW, vifPowerJh,
+                   vifVolumeFlowH, vifVolumeFlowMin, vifVolumeFlowS, vifMassFlow, vifFlowTemperature, vifReturnTemperature,
+                   vifTemperatureDiff, vifExternalTemperature, vifPressure, vifTimePoint, vifHCA, vifReserved, vifFabricationNo,
+                   vifCustom, vifManufacturer, vifExtension, vifVoltage, vifCurrent, vifQuantityCount };
 
 struct device
 {
@@ -160,6 +167,9 @@ typedef struct _mbus_data_record {
     mbus_data_record_header drh;
     quint8 data[234];
     size_t data_len;
+    int kind;           // recordKind
+    qint64 integer;     // raw integer / BCD value
+    qreal real;         // numeric value before exponent
 } mbus_data_record;
 
 //
@@ -189,7 +199,7 @@ typedef struct _mbus_data_variable_header {
 typedef struct _mbus_data_variable {
 
     mbus_data_variable_header header;
-    QList <mbus_data_record*> records;
+    QVector <mbus_data_record> records;
     quint8 *data;
     size_t  data_len;
     // are these needed/used?
@@ -403,25 +413,19 @@ static const char MBUS_VARIABLE_DATA_MEDIUM_DUAL_WATER	= 0x17;
 static const char MBUS_VARIABLE_DATA_MEDIUM_PRESSURE	= 0x18;
 static const char MBUS_VARIABLE_DATA_MEDIUM_ADC		= 0x19;
 
-#define MBusReadLoop\
-    if (!adrToRead.isEmpty())\
-    {\
-        while (!adrToRead.isEmpty())\
-        {\
-            bool ok;\
-            QString Adr = adrToRead.takeFirst();\
-            int adr = Adr.remove("Adr ").toInt(&ok);\
-            if (ok) readMbus(MySocket, adr);\
-            else str = tr("Can't Read : ") + Adr + QDateTime::currentDateTime().toString(" hh:mm");\
-        }\
-        str = tr("Read Device finished ") + QDateTime::currentDateTime().toString(" hh:mm");\
-        emit(ReadingDevDone());\
-        str += tr(" and Wait till minute %1").arg(minute);\
-        emit(whatdoUDo(str));\
-    }\
-    if (QDateTime::currentDateTime().time().minute() != minuteCheckDev) { minuteCheckDev = QDateTime::currentDateTime().time().minute(); emit(CheckDev()); } sleep(1);
+struct meterState
+{
+    int period;
+    qint64 nextRead;
+    int failures;
+};
+
+#define schedulerTick 200
+#define frameTimeout 1000
+#define maxBackoff 3600
 
 public:
+    enum readStatus { readNoAnswer, readBadFrame, readDone };
     mbusthread();
     ~mbusthread();
     void run();
@@ -437,11 +441,30 @@ public:
     int readInterval;
     QStringList devices;
     QStringList adrToRead;
+    void addMeter(int adr);
+    void setMeterPeriod(int adr, int secs);
+    void restartSearch();
+    static int intervalSecs(int index);
 private:
+    bustransport link;
+    mbus_frame_data frameData;
+    QHash <int, meterState> meters;
+    QMultiMap <qint64, int> agenda;
+    QHash <int, int> meterPeriods;
+    bool periodsChanged;
+    int scheduledInterval;
+    int searchAdr;
     void get(QTcpSocket &Socket, mbus_frame &frame, QByteArray &Data, int timeout = 30000);
+    static int frameLength(const QByteArray &data);
     void TCPconnect(QTcpSocket &Socket, QString &Status);
-    void readMbus(QTcpSocket &Socket, int adr);
-    void searchMbus(QTcpSocket &Socket);
+    int readMbus(QTcpSocket &Socket, int adr);
+    bool readRequested(QTcpSocket &Socket);
+    bool readDue(QTcpSocket &Socket);
+    void searchStep(QTcpSocket &Socket);
+    void updateSchedule(qint64 now);
+    int meterPeriod(int adr);
+    static qint64 nextDeadline(qint64 now, int secs);
+    void saveLog(int &fileIndex);
     void mbus_setType(mbus_frame &frame, int frame_type);
     int mbus_frame_pack(mbus_frame &frame, QByteArray &data);
     int mbus_frame_calc_length(mbus_frame &frame);
@@ -455,25 +478,26 @@ private:
     int mbus_frame_verify(mbus_frame &frame);
     void mbus_data_variable_print(mbus_data_variable &data, int adr);
     void mbus_data_variable_header_print(mbus_data_variable_header &header, int adr);
-    unsigned char mbus_dif_datalength_lookup(unsigned char dif);
+    static unsigned char mbus_dif_datalength_lookup(unsigned char dif);
     qint32 mbus_data_bcd_decode(quint8 *bcd_data, size_t bcd_data_size);
     QString mbus_data_variable_medium_lookup(quint8 medium);
     QString mbus_data_fixed_medium(mbus_data_fixed &data);
     QString mbus_data_fixed_unit(int medium_unit_byte);
-    QString mbus_unit_prefix(int exp);
-    QString mbus_vif_unit_lookup(quint8 vif);
-    QString mbus_vib_unit_lookup(mbus_value_information_block &vib);
+    static QString mbus_unit_prefix(int exp);
+    static QString mbus_vif_unit_lookup(quint8 vif);
+    static QString mbus_vib_unit_lookup(const mbus_value_information_block &vib);
     void mbus_dif_value_lookup(mbus_data_information_block &dib);
     const quint8 *mbus_decode_manufacturer(quint8 byte1, quint8 byte2);
-    QString mbus_data_type(mbus_data_record *record);
+    static QString mbus_data_type(const mbus_data_record &record);
     void mbus_data_str_type(QString &dst, const quint8 *src);
-    QString mbus_data_record_decode(mbus_data_record *record);
+    static QString mbus_data_record_decode(const mbus_data_record &record);
+    void mbus_data_record_value(mbus_data_record &record);
     quint32 mbus_data_int_decode(quint8 *int_data, size_t int_data_size);
     qreal mbus_data_float_decode(quint8 *int_data, size_t int_data_size);
     QDateTime mbus_data_F_Format(quint8 *int_data);
     QDate mbus_data_G_Format(quint8 *int_data);
     quint64 mbus_data_long_decode(quint8 *int_data, size_t int_data_size);
-    void mbus_data_str_decode(QString &dst, mbus_data_record *record);
+    static void mbus_data_str_decode(QString &dst, const mbus_data_record &record);
     void addTreeItem(int adr, const QString &parameter, const QString &value, const QString &comment);
     void addTreeItem(int adr, int record, const QString &parameter, const QString &value, const QString &comment, bool mainTreeItem = false);
 public slots:
@@ -485,7 +509,7 @@ signals:
     void tcpStatusUpdate(const QString&);
     void tcpStatusChange();
     void whatdoUDo(const QString&);
-    void ReadingDone();
+    void ReadingDone(int);
     void ReadingDevDone();
     void CheckDev();
 };
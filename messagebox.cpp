@@ -43,6 +43,12 @@ messageBox::~messageBox()
 
 QMessageBox::StandardButton messageBox::questionHide(QWidget*, const QString &title, const QString &text, logisdom *parent, QFlags<QMessageBox::StandardButton> buttons)
 {
+#ifdef LOGISDOM_HEADLESS
+// no one to answer, log the question and keep the non destructive choice
+	if (parent) parent->GenMsg(title + " : " + text);
+	if (buttons & No) return No;
+	return Ok;
+#endif
 	StandardButton button;
 	if (!parent) return question(parent, title, text, buttons);
 	bool hidden = parent->isPaletteHidden();
@@ -57,6 +63,10 @@ QMessageBox::StandardButton messageBox::questionHide(QWidget*, const QString &ti
 
 QMessageBox::StandardButton messageBox::criticalHide(QWidget*, const QString &title, const QString &text, logisdom *parent)
 {
+#ifdef LOGISDOM_HEADLESS
+	if (parent) parent->GenMsg(title + " : " + text);
+	return Ok;
+#endif
 	StandardButton button;
 	if (!parent) return critical(parent, title, text);
 	bool hidden = parent->isPaletteHidden();
@@ -71,6 +81,10 @@ QMessageBox::StandardButton messageBox::criticalHide(QWidget*, const QString &ti
 
 QMessageBox::StandardButton messageBox::warningHide(QWidget*, const QString &title, const QString &text, logisdom *parent, QFlags<QMessageBox::StandardButton>)
 {
+#ifdef LOGISDOM_HEADLESS
+	if (parent) parent->GenMsg(title + " : " + text);
+	return Ok;
+#endif
 	StandardButton button;
 	if (!parent) return critical(parent, title, text);
 	bool hidden = parent->isPaletteHidden();
@@ -87,6 +101,10 @@ QMessageBox::StandardButton messageBox::warningHide(QWidget*, const QString &tit
 
 void messageBox::aboutHide(QWidget*, const QString &title, const QString &text, logisdom *parent)
 {
+#ifdef LOGISDOM_HEADLESS
+	if (parent) parent->GenMsg(title + " : " + text);
+	return;
+#endif
 	if (!parent)
 	{
 		about(parent, title, text);
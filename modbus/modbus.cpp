@@ -84,6 +84,10 @@ void modbus::init()
     connect(uiw.logOnlyWrite, SIGNAL(stateChanged(int)), this, SLOT(LogWriteChanged(int)));
     connect(uiw.clearLog, SIGNAL(clicked()), this, SLOT(clearLogText()));
     connect(uiw.MuxInd , SIGNAL(valueChanged(int)), this, SLOT(MuxIndChanged(int)));
+    connect(uiw.RegisterGap, SIGNAL(valueChanged(int)), this, SLOT(RegisterGapChanged(int)));
+    connect(uiw.FrameDelay, SIGNAL(valueChanged(int)), this, SLOT(FrameDelayChanged(int)));
+    connect(uiw.PipelineWindow, SIGNAL(valueChanged(int)), this, SLOT(PipelineWindowChanged(int)));
+    uiw.PipelineWindow->setEnabled(false);
     uiw.MuxVal->setEnabled(false);
 
     ui.toolButtonClear->hide();
@@ -173,6 +177,7 @@ void modbus::tcpStatusUpdate(const QString &str)
 void modbus::ModbusTCPChanged(bool state)
 {
 	TcpThread.Modbus_TCP_Enable = state;
+    uiw.PipelineWindow->setEnabled(state);
 }
 
 
@@ -189,6 +194,27 @@ void modbus::MuxIndChanged(int val)
 
 
 
+void modbus::RegisterGapChanged(int val)
+{
+    TcpThread.registerGap = quint16(val);
+}
+
+
+
+void modbus::FrameDelayChanged(int val)
+{
+    TcpThread.frameDelay = val;
+}
+
+
+
+void modbus::PipelineWindowChanged(int val)
+{
+    TcpThread.pipelineWindow = val;
+}
+
+
+
 void modbus::tcpStatusChange()
 {
 	TcpStateChanged(TcpThread.tcpStatus);
@@ -341,6 +367,9 @@ void modbus::getConfig(QString &str)
 {
     if (uiw.Modbus_TCP_Enable->isChecked()) str += logisdom::saveformat("ModbusTCP", "1"); else str += logisdom::saveformat("Modbus_TCP_Enable", "0");
     str += logisdom::saveformat("MuxInd", QString("%1").arg(uiw.MuxInd->value()));
+    str += logisdom::saveformat("RegisterGap", QString("%1").arg(uiw.RegisterGap->value()));
+    str += logisdom::saveformat("SlaveFrameDelay", QString("%1").arg(uiw.FrameDelay->value()));
+    str += logisdom::saveformat("PipelineWindow", QString("%1").arg(uiw.PipelineWindow->value()));
 }
 
 
@@ -358,6 +387,12 @@ void modbus::setConfig(const QString &strsearch)
     if (ind < 0) ind = 20;
     uiw.MuxInd->setValue(ind);
     uiw.MuxVal->setValue(ind + 1);
+    int gap = logisdom::getvalue("RegisterGap", strsearch).toInt(&ok);
+    if (ok) uiw.RegisterGap->setValue(gap);
+    int delay = logisdom::getvalue("SlaveFrameDelay", strsearch).toInt(&ok);
+    if (ok) uiw.FrameDelay->setValue(delay);
+    int window = logisdom::getvalue("PipelineWindow", strsearch).toInt(&ok);
+    if (ok) uiw.PipelineWindow->setValue(window);
 }
 
 
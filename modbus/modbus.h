@@ -65,6 +65,9 @@ private slots:
     void ModbusTCPChanged(bool);
     void LogWriteChanged(int state);
     void MuxIndChanged(int);
+    void RegisterGapChanged(int);
+    void FrameDelayChanged(int);
+    void PipelineWindowChanged(int);
     void setDeviceScratchpad(devmodbus*, QString);
 };
 
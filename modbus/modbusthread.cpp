@@ -27,6 +27,7 @@
 
 #include <QElapsedTimer>
 #include <QTimer>
+#include <algorithm>
 #include "net1wire.h"
 #include "modbusthread.h"
 #include "globalvar.h"
@@ -68,6 +69,10 @@ void modbusthread::run()
 #ifdef Q_OS_WIN32
     //setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, (void *)&set, sizeof(int));
 #endif
+    frameClock.start();
+    lastFrame.clear();
+    link.setOwner(this, &log, &endLessLoop);
+    link.setSocket(&MySocket, &tcpStatus);
     QString msg = "Thread starts, first connection";
     TCPconnect(MySocket, msg);
     while (endLessLoop)
@@ -94,43 +99,11 @@ void modbusthread::run()
             log += addTimeTag QString("Get Multipexor data turn %1").arg(n);
             msleep(500);
         }
-        foreach (devmodbus *dev, modbusdevices)
+        QList <registerBlock> blocks = buildRegisterBlocks();
+        if (Modbus_TCP_Enable && (pipelineWindow > 1)) pipelineRegisters(MySocket, blocks);
+        else foreach (const registerBlock &block, blocks)
         {
-            if (!dev->isM3MuxEnabled)
-            {
-                if (!dev->autoRead) dev->checkRead();
-                if (dev->autoRead | dev->readNow | !dev->initialRead)
-                {
-                    unsigned char req[maxLen];
-                    quint16 slave = dev->slave;
-                    quint16 address = dev->address;
-                    quint16 function = dev->function;
-                    quint16 s = build_read_request(slave, address, dev->resolution, function, &req[0]);
-                    qint64 V = 0;
-                    log += addTimeTag "Read " + dev->getname();
-                    if (get(MySocket, &req[0], s, V))
-                    {
-                        QString v;
-                        if (dev->ValUnsigned)
-                        {
-                            if (dev->resolution == 4) v = QString("%1").arg(quint64(V));
-                            else if (dev->resolution == 2) v = QString("%1").arg(quint32(V));
-                            else v = QString("%1").arg(quint16(V));
-                        }
-                        else
-                        {
-                            if (dev->resolution == 4) v = v = QString("%1").arg(qint64(V));
-                            else if (dev->resolution == 2) v = v = QString("%1").arg(qint32(V));
-                            else v = QString("%1").arg(qint16(V));
-                        }
-                        emit(setDeviceScratchpad(dev, v));
-                        log += addTimeTag "Value : " + v;
-                        if (logOnlyWrite) log.clear();
-                        else saveLog();
-                    }
-                    msleep(100);
-                }
-            }
+            if (readRegisters(MySocket, block) == readRefused) readSingleRegisters(MySocket, block);
             if (!FIFOSpecial.isEmpty()) break;
         }
         while (!FIFOSpecial.isEmpty())
@@ -202,10 +175,7 @@ void modbusthread::run()
         else saveLog();
         sleep(1);
     }
-    MySocket.disconnectFromHost();
-    if (MySocket.state() != QAbstractSocket::UnconnectedState) MySocket.waitForDisconnected();
-    tcpStatus = MySocket.state();
-    emit(tcpStatusChange());
+    link.disconnectLink();
 }
 
 
@@ -213,39 +183,379 @@ void modbusthread::run()
 
 
 
-void modbusthread::TCPconnect(QTcpSocket &Socket, QString &Status)
+quint16 modbusthread::deviceRegisters(devmodbus *dev)
 {
-    log += addTimeTag "TCP Connect  " + Status;
-	int tryConnect = 1;
-	do
-	{
-        log += addTimeTag QString("TCP try connect %1").arg(tryConnect);
-		if (Socket.state() == QAbstractSocket::ConnectedState)
-		{
-			Socket.disconnectFromHost();
-            log += addTimeTag "Try Disconnect";
-            if (Socket.state() == QAbstractSocket::ConnectedState) Socket.waitForDisconnected();
+    if (dev->resolution > 1) return dev->resolution;
+    return 1;
+}
+
+
+
+
+QString modbusthread::valueString(devmodbus *dev, qint64 V)
+{
+    if (dev->ValUnsigned)
+    {
+        if (dev->resolution == 4) return QString("%1").arg(quint64(V));
+        else if (dev->resolution == 2) return QString("%1").arg(quint32(V));
+        else return QString("%1").arg(quint16(V));
+    }
+    if (dev->resolution == 4) return QString("%1").arg(qint64(V));
+    else if (dev->resolution == 2) return QString("%1").arg(qint32(V));
+    return QString("%1").arg(qint16(V));
+}
+
+
+
+
+// devices to read this turn grouped by slave and function, addresses closer
+// than registerGap are merged in one request of at most maxRegisters
+QList <modbusthread::registerBlock> modbusthread::buildRegisterBlocks()
+{
+    QList <devmodbus*> devices;
+    foreach (devmodbus *dev, modbusdevices)
+    {
+        if (dev->isM3MuxEnabled) continue;
+        if (!dev->autoRead) dev->checkRead();
+        if (dev->autoRead | dev->readNow | !dev->initialRead) devices.append(dev);
+    }
+    std::sort(devices.begin(), devices.end(), [](devmodbus *a, devmodbus *b)
+    {
+        if (a->slave != b->slave) return a->slave < b->slave;
+        if (a->function != b->function) return a->function < b->function;
+        return a->address < b->address;
+    });
+    QList <registerBlock> blocks;
+    foreach (devmodbus *dev, devices)
+    {
+        int end = dev->address + deviceRegisters(dev);
+        if (!blocks.isEmpty())
+        {
+            registerBlock &last = blocks.last();
+            int lastEnd = last.address + last.count;
+            if ((last.slave == dev->slave) && (last.function == dev->function) && (dev->address <= lastEnd + registerGap) && (qMax(end, lastEnd) - last.address <= maxRegisters))
+            {
+                last.count = quint16(qMax(end, lastEnd) - last.address);
+                last.devices.append(dev);
+                continue;
+            }
         }
-        if (Socket.state() == QAbstractSocket::UnconnectedState) log += addTimeTag "Disconnect OK";
-		tcpStatus = Socket.state();
-		emit(tcpStatusChange());
-        if (endLessLoop)
+        registerBlock block;
+        block.slave = dev->slave;
+        block.function = dev->function;
+        block.address = dev->address;
+        block.count = deviceRegisters(dev);
+        block.devices.append(dev);
+        blocks.append(block);
+    }
+    return blocks;
+}
+
+
+
+
+// keep frameDelay between two frames sent to the same slave
+void modbusthread::waitSlave(quint16 slave)
+{
+    if (!lastFrame.contains(slave)) return;
+    qint64 elapsed = frameClock.elapsed() - lastFrame.value(slave);
+    if (elapsed < frameDelay) msleep(unsigned(frameDelay - elapsed));
+}
+
+
+
+
+int modbusthread::readRegisters(QTcpSocket &Socket, const registerBlock &block)
+{
+    unsigned char req[maxLen];
+    quint16 s = build_read_request(block.slave, block.address, block.count, block.function, &req[0]);
+    QVector <quint16> registers(block.count);
+    QString names;
+    foreach (devmodbus *dev, block.devices) names += " " + dev->getname();
+    log += addTimeTag QString("Read %1 registers from %2 :").arg(block.count).arg(block.address) + names;
+    waitSlave(block.slave);
+    qint64 sent = frameClock.elapsed();
+    int status = getRegisters(Socket, &req[0], s, registers);
+    lastFrame[block.slave] = frameClock.elapsed();
+    if (status != readOk) return status;
+    setLatency(block.slave, sent);
+    decodeRegisters(block, registers);
+    if (logOnlyWrite) log.clear();
+    else saveLog();
+    return readOk;
+}
+
+
+
+
+// one register of a merged range may not exist, read its devices one by one,
+// only called when the slave refused the range, a silent slave is not asked again
+void modbusthread::readSingleRegisters(QTcpSocket &Socket, const registerBlock &block)
+{
+    if (block.devices.count() < 2) return;
+    foreach (devmodbus *dev, block.devices)
+    {
+        registerBlock single;
+        single.slave = dev->slave;
+        single.function = dev->function;
+        single.address = dev->address;
+        single.count = deviceRegisters(dev);
+        single.devices.append(dev);
+        if (readRegisters(Socket, single) == readNoAnswer) return;
+    }
+}
+
+
+
+
+void modbusthread::decodeRegisters(const registerBlock &block, const QVector <quint16> &registers)
+{
+    foreach (devmodbus *dev, block.devices)
+    {
+        // low word first like the single device answers
+        quint64 V = 0;
+        int offset = dev->address - block.address;
+        for (int n=deviceRegisters(dev)-1; n>=0; n--) V = (V << 16) | registers.at(offset + n);
+        QString v = valueString(dev, qint64(V));
+        emit(setDeviceScratchpad(dev, v));
+        log += addTimeTag dev->getname() + " Value : " + v;
+    }
+}
+
+
+
+
+void modbusthread::setLatency(quint16 slave, qint64 sent)
+{
+    qint64 latency = frameClock.elapsed() - sent;
+    log += addTimeTag QString("Slave %1 round trip %2 ms").arg(slave).arg(latency);
+}
+
+
+
+
+// Modbus TCP only : keep up to pipelineWindow requests in flight and match
+// the answers with the MBAP transaction ID, failed ranges are read again one by one
+void modbusthread::pipelineRegisters(QTcpSocket &Socket, const QList <registerBlock> &blocks)
+{
+    QHash <quint16, pendingRequest> inFlight;
+    QList <registerBlock> failed;
+    QByteArray Data;
+    int next = 0;
+    while (((next < blocks.count()) && FIFOSpecial.isEmpty()) || !inFlight.isEmpty())
+    {
+        if (Socket.state() != QAbstractSocket::ConnectedState)
         {
-            Socket.connectToHost(moduleipaddress, port);
-            log += addTimeTag "Try Connect";
-            Socket.waitForConnected();
-            if (Socket.state() == QAbstractSocket::ConnectedState) log += addTimeTag "Connect OK";
-            tcpStatus = Socket.state();
-            emit(tcpStatusChange());
-            tryConnect ++;
+            QString msg = QString("Socket error with %1 requests in flight, reconnect").arg(inFlight.count());
+            TCPconnect(Socket, msg);
+            return;
         }
-        if (tryConnect > 10)
+        while ((next < blocks.count()) && (inFlight.count() < pipelineWindow) && FIFOSpecial.isEmpty())
         {
-            log.clear();
-            tryConnect = 0;
+            const registerBlock &block = blocks.at(next++);
+            unsigned char req[maxLen];
+            quint16 s = build_read_request(block.slave, block.address, block.count, block.function, &req[0]);
+            QString hex_request;
+            for (quint16 n=0; n<s; n++) hex_request += QString("%1 ").arg(uchar(req[n]), 2, 16, QChar('0')).toUpper();
+            log += addTimeTag QString("Read %1 registers from %2 ID %3").arg(block.count).arg(block.address).arg(TCP_ID);
+            log += addTimeTag " SEND : "+ hex_request;
+            pendingRequest request;
+            request.block = block;
+            request.sent = frameClock.elapsed();
+            inFlight.insert(TCP_ID, request);
+            if (!link.send(QByteArray(reinterpret_cast<const char*>(&req[0]), s))) log += addTimeTag "Error writing data : " + hex_request;
+        }
+        link.receive(Data, 250);
+        // MBAP header : ID(2) protocol(2) length(2), length counts from the unit byte
+        while (Data.length() >= 7)
+        {
+            int frameLength = 6 + ((uchar(Data.at(4)) << 8) | uchar(Data.at(5)));
+            if (Data.length() < frameLength) break;
+            checkPipelineAnswer(Data.left(frameLength), inFlight, failed);
+            Data.remove(0, frameLength);
+        }
+        qint64 now = frameClock.elapsed();
+        foreach (quint16 id, inFlight.keys())
+        {
+            if (now - inFlight.value(id).sent < answerTimeout) continue;
+            log += addTimeTag QString("No answer for ID %1 slave %2").arg(id).arg(inFlight.value(id).block.slave);
+            link.frameLost();
+            inFlight.remove(id);
         }
     }
-    while ((Socket.state() != QAbstractSocket::ConnectedState) && (endLessLoop));
+    if (logOnlyWrite) log.clear();
+    else saveLog();
+    foreach (const registerBlock &block, failed)
+    {
+        readSingleRegisters(Socket, block);
+        if (!FIFOSpecial.isEmpty()) break;
+    }
+}
+
+
+
+
+bool modbusthread::checkPipelineAnswer(const QByteArray &frame, QHash <quint16, pendingRequest> &inFlight, QList <registerBlock> &failed)
+{
+    QString hex;
+    for (int n=0; n<frame.length(); n++) hex += QString("%1 ").arg(uchar(frame.at(n)), 2, 16, QChar('0')).toUpper();
+    log += addTimeTag " GET : " + hex;
+    const uchar *answer = reinterpret_cast<const uchar*>(frame.constData());
+    quint16 id = quint16((answer[0] << 8) | answer[1]);
+    if (!inFlight.contains(id))
+    {
+        log += addTimeTag QString("Request ID Error %1").arg(id);
+        return false;
+    }
+    pendingRequest request = inFlight.take(id);
+    setLatency(request.block.slave, request.sent);
+    link.frameDone(frameClock.elapsed() - request.sent);
+    if ((frame.length() > 8) && (answer[7] & 0x80))
+    {
+        handle_Excpetion(answer[8]);
+        failed.append(request.block);
+        return false;
+    }
+    if ((frame.length() < 9) || (answer[8] != request.block.count * 2) || (frame.length() < 9 + request.block.count * 2))
+    {
+        log += addTimeTag "Byte count error";
+        failed.append(request.block);
+        return false;
+    }
+    QVector <quint16> registers(request.block.count);
+    for (int n=0; n<registers.count(); n++) registers[n] = quint16((answer[9 + n*2] << 8) | answer[10 + n*2]);
+    decodeRegisters(request.block, registers);
+    return true;
+}
+
+
+
+
+int modbusthread::getRegisters(QTcpSocket &Socket, const unsigned char *request, const unsigned int inLen, QVector <quint16> &registers)
+{
+    QString hex_request;
+    for (quint16 n=0; n<inLen; n++) hex_request += QString("%1 ").arg(uchar(request[n]), 2, 16, QChar('0')).toUpper();
+    log += addTimeTag " SEND : "+ hex_request;
+    if (Socket.state() != QAbstractSocket::ConnectedState)
+    {
+        QString msg = "Socket error before writing, reconnect, request = " + hex_request;
+        TCPconnect(Socket, msg);
+        return readNoAnswer;
+    }
+    // answer : MBAP(7) or slave(1), function, byte count, data, CRC(2) for RTU
+    int functionIndex = Modbus_TCP_Enable ? 7 : 1;
+    int dataIndex = functionIndex + 2;
+    int length = dataIndex + registers.count() * 2 + (Modbus_TCP_Enable ? 0 : 2);
+    QByteArray Data;
+    link.setFrameSize(Modbus_TCP_Enable ? tcpFrameLength : rtuFrameLength);
+    int result = link.request(QByteArray(reinterpret_cast<const char*>(request), int(inLen)), Data, 5000);
+    if (result == bustransport::requestWriteError)
+    {
+        log += addTimeTag "Error writing data : " + hex_request;
+        return readNoAnswer;
+    }
+    if (result == bustransport::requestTimeout)
+    {
+        QString msg = "No answer, reconnect socket, request = " + hex_request;
+        TCPconnect(Socket, msg);
+        return readNoAnswer;
+    }
+    QString hex;
+    for (int n=0; n<Data.length(); n++) hex += QString("%1 ").arg(uchar(Data.at(n)), 2, 16, QChar('0')).toUpper();
+    log += addTimeTag " GET : " + hex;
+    const uchar *answer = reinterpret_cast<const uchar*>(Data.constData());
+    if ((Data.length() > functionIndex + 1) && (answer[functionIndex] & 0x80))
+    {
+        handle_Excpetion(answer[functionIndex + 1]);
+        return readRefused;
+    }
+    if (Data.length() < length)
+    {
+        log += addTimeTag "Not enough data";
+        return readBadFrame;
+    }
+    if (Modbus_TCP_Enable)
+    {
+        if ((answer[0] != request[0]) || (answer[1] != request[1]))
+        {
+            log += addTimeTag "Request ID Error";
+            return readBadFrame;
+        }
+    }
+    else
+    {
+        quint16 crc_received = quint16((answer[length-2] << 8) | answer[length-1]);
+        if (calcCRC16(answer, quint16(length-2)) != crc_received)
+        {
+            log += addTimeTag " Bad CRC";
+            return readBadFrame;
+        }
+    }
+    if (answer[functionIndex + 1] != registers.count() * 2)
+    {
+        log += addTimeTag "Byte count error";
+        return readRefused;
+    }
+    for (int n=0; n<registers.count(); n++) registers[n] = quint16((answer[dataIndex + n*2] << 8) | answer[dataIndex + n*2 + 1]);
+    return readOk;
+}
+
+
+
+
+void modbusthread::TCPconnect(QTcpSocket &, QString &Status)
+{
+    link.connectLink(moduleipaddress, port, Status);
+}
+
+
+
+
+// MBAP header : ID(2) protocol(2) length(2), length counts from the unit byte
+int modbusthread::tcpFrameLength(const QByteArray &data)
+{
+    if (data.length() < 6) return 0;
+    return 6 + ((uchar(data.at(4)) << 8) | uchar(data.at(5)));
+}
+
+
+
+
+// slave, function, then exception code or byte count and data, CRC(2)
+// 0 for an unknown function, the answer then ends on the timeout
+int modbusthread::rtuFrameLength(const QByteArray &data)
+{
+    if (data.length() < 3) return 0;
+    uchar function = uchar(data.at(1));
+    if (function & 0x80) return 5;
+    switch (function)
+    {
+        case 0x01 :     // read coils
+        case 0x02 :     // read discrete inputs
+        case 0x03 :     // read holding registers
+        case 0x04 :     // read input registers
+        case 0x0C :     // get comm event log
+        case 0x11 :     // report server ID
+        case 0x14 :     // read file record
+        case 0x15 :     // write file record
+        case 0x17 :     // read/write multiple registers
+            return uchar(data.at(2)) + 5;
+        case 0x07 :     // read exception status
+            return 5;
+        case 0x05 :     // write single coil
+        case 0x06 :     // write single register
+        case 0x08 :     // diagnostics
+        case 0x0B :     // get comm event counter
+        case 0x0F :     // write multiple coils
+        case 0x10 :     // write multiple registers
+            return 8;
+        case 0x16 :     // mask write register
+            return 10;
+        case 0x18 :     // read FIFO queue, 2 bytes count
+            if (data.length() < 4) return 0;
+            return ((uchar(data.at(2)) << 8) | uchar(data.at(3))) + 6;
+    }
+    return 0;
 }
 
 
@@ -369,18 +679,14 @@ bool modbusthread::get(QTcpSocket &Socket, const unsigned char *request, const u
     log += addTimeTag " SEND : "+ hex_request;
 	if (Socket.state() == QAbstractSocket::ConnectedState)
 	{
-        char req[inLen];
         uchar function = 0;
-		for (quint16 n=0; n<inLen; n++) req[n] = request[n];
-		if (Socket.isValid()) Socket.write(req, inLen);
-		else return logisdom::NA;
-		if (Socket.waitForBytesWritten())
+        QByteArray Data;
+        link.setFrameSize(Modbus_TCP_Enable ? tcpFrameLength : rtuFrameLength);
+        int result = link.request(QByteArray(reinterpret_cast<const char*>(request), int(inLen)), Data, 5000, 1000);
+		if (result != bustransport::requestWriteError)
 		{
-            msleep(200);
-            if (Socket.waitForReadyRead(5000))
+            if (result != bustransport::requestTimeout)
             {
-                QByteArray Data;
-				Data.append(Socket.readAll());
 				quint16 read_length = Data.length();
 				QString hex;
 				for (int n=0; n<read_length; n++)
@@ -525,11 +831,7 @@ bool modbusthread::write(QTcpSocket &Socket, const unsigned char *request, const
     log += addTimeTag " SEND : "+ hex_request;
     if (Socket.state() == QAbstractSocket::ConnectedState)
     {
-        char req[inLen];
-        for (quint16 n=0; n<inLen; n++) req[n] = request[n];
-        if (Socket.isValid()) Socket.write(req, inLen);
-        else return logisdom::NA;
-        if (!Socket.waitForBytesWritten(5000))
+        if (!link.send(QByteArray(reinterpret_cast<const char*>(request), int(inLen))))
         {
             log += addTimeTag "Error writing data : " + hex_request;
             return false;
@@ -555,7 +857,7 @@ void modbusthread::saveLog()
         log.clear();
         return;
     }
-    if (!log.isEmpty()) emit(tcpStatusUpdate(log));
+    if (!log.isEmpty()) emit(tcpStatusUpdate(log + addTimeTag link.statistics()));
     log.clear();
 }
 
@@ -27,6 +27,8 @@
 #include <QtCore>
 #include <QThread>
 #include <QTcpSocket>
+#include <QElapsedTimer>
+#include "bustransport.h"
 
 #include "devmodbus.h"
 
@@ -45,8 +47,26 @@ struct device
     int isAlive;
     bool muxHasBeenRead;
 };
+// adjacent registers of one slave read with a single request
+struct registerBlock
+{
+    quint16 slave;
+    quint16 function;
+    quint16 address;
+    quint16 count;
+    QList <devmodbus*> devices;
+};
+// Modbus TCP request waiting for its answer, matched by transaction ID
+struct pendingRequest
+{
+    registerBlock block;
+    qint64 sent;
+};
 #define maxLen 100
+#define maxRegisters 125
+#define answerTimeout 5000
 public:
+    enum readStatus { readOk, readNoAnswer, readBadFrame, readRefused };
 	modbusthread();
 	~modbusthread();
 	void run();
@@ -65,7 +85,26 @@ public:
     bool Modbus_TCP_Enable = false;
     quint16 TCP_ID;
     QList <devmodbus*> modbusdevices;
+    quint16 registerGap = 8;
+    int frameDelay = 100;
+    int pipelineWindow = 1;
 private:
+    bustransport link;
+    static int tcpFrameLength(const QByteArray &data);
+    static int rtuFrameLength(const QByteArray &data);
+    void pipelineRegisters(QTcpSocket &Socket, const QList <registerBlock> &blocks);
+    bool checkPipelineAnswer(const QByteArray &frame, QHash <quint16, pendingRequest> &inFlight, QList <registerBlock> &failed);
+    void readSingleRegisters(QTcpSocket &Socket, const registerBlock &block);
+    void decodeRegisters(const registerBlock &block, const QVector <quint16> &registers);
+    void setLatency(quint16 slave, qint64 sent);
+    QElapsedTimer frameClock;
+    QHash <quint16, qint64> lastFrame;
+    QList <registerBlock> buildRegisterBlocks();
+    int readRegisters(QTcpSocket &Socket, const registerBlock &block);
+    int getRegisters(QTcpSocket &Socket, const unsigned char *request, const unsigned int inLen, QVector <quint16> &registers);
+    void waitSlave(quint16 slave);
+    static quint16 deviceRegisters(devmodbus *dev);
+    static QString valueString(devmodbus *dev, qint64 V);
     bool get(QTcpSocket &Socket, const unsigned char *request, const unsigned int inLen, qint64 &value);
     bool write(QTcpSocket &Socket, const unsigned char *request, const unsigned int inLen, qint16 &value);
     void handle_Excpetion(const unsigned char code);
@@ -82,6 +82,9 @@ net1wire::net1wire(logisdom *Parent)
 	connect(&TimerReqDone, SIGNAL(timeout()), this, SLOT(emitReqDone()));
 	TimerReqDone.setSingleShot(true);
 	TimerReqDone.setInterval(250);
+	fifoViewDirty = false;
+	connect(&fifoViewTimer, SIGNAL(timeout()), this, SLOT(updateFifoView()));
+	fifoViewTimer.start(1000);
 	settraffic(Disabled);
 	ErrorLog = parent->alarmwindow->newTab("no name");
 }
@@ -156,23 +159,59 @@ QString net1wire::port2Hex(int P)
 
 
 
+// every order is indexed by its full text and by its text without data
+// and without RomID, so a new order already contained in a pending one is found at once
+QStringList net1wire::fifoIndexKeys(const QString &text)
+{
+	QStringList keys;
+	keys.append(text);
+	int data = text.indexOf("[");
+	if (data > 0) keys.append(text.left(data));
+	int romid = text.indexOf("{");
+	if (romid > 0) keys.append(text.left(romid));
+	return keys;
+}
+
+
+
+void net1wire::fifoIndexAdd(const QString &order)
+{
+	foreach (const QString &key, fifoIndexKeys(order)) fifoIndex[key]++;
+	fifoViewDirty = true;
+}
+
+
+
+void net1wire::fifoIndexRemove(const QString &order)
+{
+	foreach (const QString &key, fifoIndexKeys(order))
+		if (--fifoIndex[key] <= 0) fifoIndex.remove(key);
+	fifoViewDirty = true;
+}
+
+
+
+bool net1wire::fifoListHas(const QString &Order)
+{
+	QMutexLocker locker(&mutexFifoList);
+	return fifoIndex.contains(Order);
+}
+
+
+
 void net1wire::fifoListRemoveFirst()
 {
 	QMutexLocker locker(&mutexFifoList);
-	if (ui.fifolist->count() > 0)
-	{
-		QListWidgetItem *item = ui.fifolist->takeItem(0);
-		if (item) delete item;
-	}
+	if (fifoQueue.count() > 0) fifoIndexRemove(fifoQueue.takeFirst());
 }
 
 
 void net1wire::fifoListInsertFirst(const QString &order, int position)
 {
 	QMutexLocker locker(&mutexFifoList);
-	QListWidgetItem *item = new QListWidgetItem(order);
-	if (ui.fifolist->count() > 0)	ui.fifolist->insertItem(position, item);
-	else ui.fifolist->addItem(item);
+	if (position < fifoQueue.count()) fifoQueue.insert(position, order);
+	else fifoQueue.append(order);
+	fifoIndexAdd(order);
 }
 
 
@@ -180,8 +219,8 @@ void net1wire::fifoListInsertFirst(const QString &order, int position)
 void net1wire::fifoListAdd(const QString &order)
 {
 	QMutexLocker locker(&mutexFifoList);
-	QListWidgetItem *item = new QListWidgetItem(order);
-	ui.fifolist->addItem(item);
+	fifoQueue.append(order);
+	fifoIndexAdd(order);
 }
 
 
@@ -189,11 +228,7 @@ void net1wire::fifoListAdd(const QString &order)
 QString net1wire::fifoListNext()
 {
 	QMutexLocker locker(&mutexFifoList);
-	if (ui.fifolist->count() > 0)
-	{
-		QString next = ui.fifolist->item(0)->text();
-		return next;
-	}
+	if (fifoQueue.count() > 0) return fifoQueue.first();
 	else return "";
 }
 
@@ -203,23 +238,36 @@ QString net1wire::fifoListNext()
 QString net1wire::fifoListLast()
 {
 	QMutexLocker locker(&mutexFifoList);
-	int count = ui.fifolist->count();
-	if (count > 0)
-	{
-		QString last = ui.fifolist->item(count - 1)->text();
-		return last;
-	}
+	if (fifoQueue.count() > 0) return fifoQueue.last();
 	else return "";
 }
 
 
 
 
+QString net1wire::fifoListAt(int index)
+{
+	QMutexLocker locker(&mutexFifoList);
+	if ((index >= 0) && (index < fifoQueue.count())) return fifoQueue.at(index);
+	return "";
+}
+
+
+
+
+void net1wire::fifoListRemoveAt(int index)
+{
+	QMutexLocker locker(&mutexFifoList);
+	if ((index >= 0) && (index < fifoQueue.count())) fifoIndexRemove(fifoQueue.takeAt(index));
+}
+
+
+
+
 bool net1wire::fifoListEmpty()
 {
 	QMutexLocker locker(&mutexFifoList);
-	if (ui.fifolist->count() != 0) return false;
-	return true;
+	return fifoQueue.isEmpty();
 }
 
 
@@ -230,8 +278,9 @@ bool net1wire::fifoListEmpty()
 bool net1wire::fifoListContains(const QString &str)
 {
 	QMutexLocker locker(&mutexFifoList);
-	for (int n=0; n<ui.fifolist->count(); n++)
-		if (ui.fifolist->item(n)->text().contains(str)) return true;
+	if (fifoIndex.contains(str)) return true;
+	for (int n=0; n<fifoQueue.count(); n++)
+		if (fifoQueue.at(n).contains(str)) return true;
 	return false;
 }
 
@@ -241,7 +290,27 @@ bool net1wire::fifoListContains(const QString &str)
 int net1wire::fifoListCount()
 {
 	QMutexLocker locker(&mutexFifoList);
-	return ui.fifolist->count();
+	return fifoQueue.count();
+}
+
+
+
+
+// the list widget only shows a snapshot of the queue, refreshed by fifoViewTimer
+void net1wire::updateFifoView()
+{
+	QStringList snapshot;
+	mutexFifoList.lock();
+	if (!fifoViewDirty)
+	{
+		mutexFifoList.unlock();
+		return;
+	}
+	fifoViewDirty = false;
+	snapshot = fifoQueue.mid(0, fifoViewMax);
+	mutexFifoList.unlock();
+	ui.fifolist->clear();
+	ui.fifolist->addItems(snapshot);
 }
 
 
@@ -313,6 +382,7 @@ void net1wire::init()
 
 void net1wire::UpdateLocalDeviceList()
 {
+	localDeviceRevision++;
 	ui.localdevicecombolist->clear();
 	for (int n=0; n<localdevice.count(); n++)
 	{
@@ -1066,13 +1136,13 @@ void net1wire::addtofifo(const QString &order)
 	QMutexLocker locker(&mutex);
 	TimerReqDone.stop();
 	QString Order = getFifoString(order, "", "");
-	if (ui.fifolist->count() > fifomax)
+	if (fifoListCount() > fifomax)
 	{
 		GenError(83, order);
 		TimerReqDone.start();
 		return;		// si fifo trop plein on quitte
 	}
-	if ((Order != NetRequestMsg[Reset]) and (fifoListContains(Order)))
+	if ((Order != NetRequestMsg[Reset]) and (fifoListHas(Order)))
 	{
 		TimerReqDone.start();
 		return;
@@ -1101,7 +1171,7 @@ void net1wire::addtofifo(int order)
 		TimerReqDone.start();
 		return;		// si fifo trop plein on quitte
 	}
-	if ((Order != NetRequestMsg[Reset]) and (fifoListContains(Order)))
+	if ((Order != NetRequestMsg[Reset]) and (fifoListHas(Order)))
 	{
 		TimerReqDone.start();
 		return;
@@ -1131,7 +1201,7 @@ void net1wire::addtofifo(int order, const QString &RomID, bool priority)
 		TimerReqDone.start();
 		return;		// si fifo trop plein on quitte
 	}
-	if ((Order != NetRequestMsg[Reset]) and (fifoListContains(Order)))
+	if ((Order != NetRequestMsg[Reset]) and (fifoListHas(Order)))
 	{
 		TimerReqDone.start();
 		return;
@@ -1162,12 +1232,12 @@ void net1wire::addtofifo(int order, const QString &RomID, const QString &Data, b
 		TimerReqDone.start();
 		return;		// si fifo trop plein on quitte
 	}
-	if ((Order != NetRequestMsg[Reset]) and (fifoListContains(Order)))
+	if ((Order != NetRequestMsg[Reset]) and (fifoListHas(Order)))
 	{
 		TimerReqDone.start();
 		return;
 	}
-    if ((priority) and (ui.fifolist->count() > 2)) fifoListInsertFirst(Order);
+    if ((priority) and (fifoListCount() > 2)) fifoListInsertFirst(Order);
     else fifoListAdd(Order);
 //	removeDuplicates();
 	GenMsg(" addtofifo -> " + Order);
@@ -1182,7 +1252,9 @@ void net1wire::addtofifo(int order, const QString &RomID, const QString &Data, b
 void net1wire::clearfifo()
 {
 	QMutexLocker locker(&mutexFifoList);
-	ui.fifolist->clear();
+	fifoQueue.clear();
+	fifoIndex.clear();
+	fifoViewDirty = true;
 }
 
 
@@ -1198,9 +1270,7 @@ void net1wire::removeDuplicates()
 void net1wire::addremotefifo(QString &str)
 {
 	TimerReqDone.stop();
-	QMutexLocker locker(&mutexFifoList);
-	QListWidgetItem *item = new QListWidgetItem(str);
-	ui.fifolist->addItem(item);
+	fifoListAdd(str);
 	GenMsg(" addtofifo -> " + str);
 	TimerReqDone.start();
 	//emit requestdone();
@@ -1276,8 +1346,8 @@ QString net1wire::getFifoString(const QString Order, const QString RomID, const
 
 void net1wire::voiralldevice()
 {
-	for (int n=0; n<parent->configwin->devicePtArray.count(); n++)
-		if (parent->configwin->devicePtArray[n]->getMaster() == this) parent->configwin->devicePtArray[n]->show();
+	foreach (onewiredevice *device, parent->configwin->deviceRegistry.byMaster(this))
+		device->show();
 }
 
 
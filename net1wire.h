@@ -46,6 +46,7 @@ class eocean;
 class net1wire : public QWidget
 {
 #define fifomax 1000
+#define fifoViewMax 200
 	Q_OBJECT
 	friend class ha7net;
 	friend class fts800;
@@ -84,6 +85,15 @@ private:		// functions
 	void settabtraffic(int state);
 	QList <onewiredevice*> localdevice;
     bool tobeDeleted;
+	// pending bus orders, in the *Order#{RomID}[Data] form given to the masters
+	QStringList fifoQueue;
+	QHash <QString, int> fifoIndex;
+	bool fifoViewDirty;
+	QTimer fifoViewTimer;
+	static QStringList fifoIndexKeys(const QString &text);
+	void fifoIndexAdd(const QString &order);
+	void fifoIndexRemove(const QString &order);
+	bool fifoListHas(const QString &Order);
     QIcon runIcon, stopIcon, tcpIconUnconnectedState, tcpIconHostLookupState, tcpIconConnectingState, tcpIconConnectedState, tcpIconClosingState;
 public:
 	net1wire(logisdom *Parent);
@@ -97,6 +107,7 @@ public:
     virtual bool receiveData();
 	QTimer TimerReqDone;
 	void UpdateLocalDeviceList();
+	quint64 localDeviceRevision = 0;
 	QDateTime lastConnectionRequest;
 	void writeTcp(char c);
 	void writeTcp(const QByteArray req);
@@ -116,6 +127,8 @@ public:
 	bool fifoListEmpty();
 	bool fifoListContains(const QString &str);
     int fifoListCount();
+	QString fifoListAt(int index);
+	void fifoListRemoveAt(int index);
 	virtual void setport(int Port);
 	QString getipaddress();
 	QString getname();
@@ -179,6 +192,7 @@ private slots:
 	void switchOn();
 	void switchOff();
 	void clearfifo();
+	void updateFifoView();
 	void TcpStateChanged(QAbstractSocket::SocketState);
 	void emitReqDone();
     void deviceReturn(const QString, const QString);
@@ -50,6 +50,7 @@ onewiredevice::onewiredevice(net1wire *Master, logisdom *Parent, QString RomID)
 	qRegisterMetaType<onewiredevice*>();
 	QDateTime Now = QDateTime::currentDateTime();
     romid = RomID;
+    saveInterval.setKey(romid);
 	lastFreeMem = Now.date();
 	lastMainValue = logisdom::NA;
 	MainValue = logisdom::NA;
@@ -380,6 +381,7 @@ void onewiredevice::setname(const QString &NameStr)
 	}
 	// check duplicate name & rename if already exist
 	name = assignname(Name);
+    if (parent->configwin) parent->configwin->renameDevice(this);
 	setWindowTitle(name);
 	RenameButton.setText(name);
 	htmlBind->setName(name);
@@ -409,6 +411,7 @@ retry:
 			goto retry;
 		}
 		name = Name;
+        parent->configwin->renameDevice(this);
 		setWindowTitle(Name);
         RenameButton.setText(Name);
         if (plugin_interface) plugin_interface->setDeviceConfig("setDeviceName",  romid + "//" + name);
@@ -766,250 +769,6 @@ bool onewiredevice::hasPreviousDatFile()
 
 
 
-bool onewiredevice::fileAlreadyInsideZip(QString datfileName, QString zipFileName)
-{
-	QMutexLocker locker(&mutexGet);
-	parent->GenMsg("Check zip File " + zipFileName + " if " + datfileName + " already inside zip");
-	QuaZip zipFile(zipFileName);
-	if (zipFile.open(QuaZip::mdUnzip))
-	{
-                QTextCodec *codec = zipFile.getFileNameCodec();
-                zipFile.setFileNameCodec(codec);
-                //zipFile.setFileNameCodec("IBM866");
-		QuaZipFileInfo info;
-		QuaZipFile datFile(&zipFile);
-		QString filename;
-		for(bool more=zipFile.goToFirstFile(); more; more=zipFile.goToNextFile())
-		{
-			if (zipFile.getCurrentFileInfo(&info))
-			{
-				if (datFile.getZipError() == UNZ_OK)
-				{
-					filename = datFile.getActualFileName();
-					//parent->GenMsg("next file " + filename + " in zipfile ");
-					if (filename == datfileName)
-					{
-						//parent->GenMsg("file " + datfileName + " found");
-						zipFile.close();
-						return true;
-					}
-				}
-			}
-		}
-		zipFile.close();
-	}
-	//parent->GenMsg("file " + datfileName + " not found");
-	return false;
-}
-
-
-
-
-bool onewiredevice::copyZipWithoutFile(QString datfileName, QString zipFileName)
-{
-    QMutexLocker locker(&mutexGet);
-    QString tempFileName = QString(parent->getrepertoiredat()) + romid + ".tmp";
-    QuaZip zipFile(zipFileName);
-    QuaZip tempZipFile(tempFileName);
-    bool success = true;
-	if (zipFile.open(QuaZip::mdUnzip) && tempZipFile.open(QuaZip::mdCreate))
-	{
-                QTextCodec *codec = zipFile.getFileNameCodec();
-                zipFile.setFileNameCodec(codec);
-                //zipFile.setFileNameCodec("IBM866");
-                QuaZipFileInfo info;
-		QuaZipFile datFile(&zipFile);
-		QuaZipFile tempDatFile(&tempZipFile);
-		QString currentfilename;
-		for(bool more=zipFile.goToFirstFile(); more; more=zipFile.goToNextFile())
-		{
-			if (zipFile.getCurrentFileInfo(&info))
-			{
-				if (datFile.getZipError() == UNZ_OK)
-				{
-					currentfilename = datFile.getActualFileName();
-					//parent->GenMsg("Found " + currentfilename + " in " + zipFileName);
-					if (currentfilename != datfileName)
-					{
-						if (datFile.open(QIODevice::ReadOnly) && tempDatFile.open(QIODevice::WriteOnly, QuaZipNewInfo(currentfilename, currentfilename)))
-						{
-							//parent->GenMsg("Copy " + currentfilename + " in new zip file");
-							QByteArray data = datFile.readAll();
-							datFile.close();
-							tempDatFile.write(data);
-							if (tempDatFile.getZipError() != UNZ_OK)
-							{
-								success = false;
-								parent->GenMsg("Cannot write Zip file " + tempFileName);
-							}
-							tempDatFile.close();
-							if (tempDatFile.getZipError() != UNZ_OK)
-							{
-								success = false;
-								parent->GenMsg("Cannot write Zip file " + tempFileName);
-							}
-						}
-						else
-						{
-							parent->GenMsg("Cannot open file into zip");
-							zipFile.close();
-							tempZipFile.close();
-							QFile tmpZipFile(tempFileName);
-							tmpZipFile.remove();
-							return false;
-						}
-					}
-					else parent->GenMsg("Don't copy " + currentfilename + " in new zip file");
-				}
-				else success = false;
-			}
-		}
-                zipFile.close();
-                tempZipFile.close();
-		if (success)
-		{
-			QFile oldZipFile(zipFileName);
-                        if (oldZipFile.remove())
-                        {
-                            QFile newZipFile(tempFileName);
-                            if (newZipFile.rename(zipFileName))
-                            {
-                                parent->GenMsg("File " + zipFileName + " was successfully copied without " + datfileName);
-                                return true;
-                            }
-                        }
-                        else
-                        {
-                            parent->GenMsg("File " + zipFileName + " cannot be removed");
-                        }
-		}
-	}
-	return false;
-}
-
-
-
-
-bool onewiredevice::zipPreviousDatFile()
-{
-	if (isReprocessing())
-	{
-		//parent->GenMsg("Zipping aborted " + romid + " reprocessing running");
-		return false;
-	}
-	//parent->GenMsg("Start zipping " + romid);
-	QString datfilename;
-	QString shortFileName;
-	QString zipFileName;
-// File search
-	QDateTime now = QDateTime::currentDateTime();
-	QDir fileSearch(parent->getrepertoiredat());
-	QStringList filters;
-	filters << romid + "*.dat";
-	QStringList fileList = fileSearch.entryList(filters);	// Get file list with same RomID
-	if (fileList.count() < 2) return false;
-	//parent->GenMsg(QString("found %1 files ").arg(fileList.count()));
-	for (int n=0; n<fileList.count(); n++)		// For each file
-	{
-		//parent->GenMsg(QString(fileList.at(n)));
-		QString YM = fileList.at(n);	// get current file
-		YM.chop(4);		// remove extension
-		YM = YM.right(7);	// take year and month
-		int idL = romid.length();
-		QString id = fileList.at(n).left(idL);
-		bool okY, okM;
-		int Y = YM.right(4).toInt(&okY);
-		int M = YM.left(2).toInt(&okM);
-		if (okY && okM && (id == romid))  // if romid is ok and to Int succeed
-		{
-			if (!((Y == now.date().year()) && (M == now.date().month())))	// if file is not actual month
-			{
-				shortFileName = fileList.at(n);
-				parent->GenMsg("Add " + shortFileName + " to zip file");
-				datfilename = QString(parent->getrepertoiredat()) + fileList.at(n);
-                zipFileName = QString(parent->getrepertoirezip()) + romid + "_" + QString("%1").arg(Y, 4, 10, QChar('0')) + ".zip";
-				break;
-			}
-		}
-	}
-	if (datfilename.isEmpty())
-	{
-		//parent->GenMsg("No file found " + romid);
-		return false;		// not dat file found
-	}
-	QFile datfile(datfilename);
-	if (datfile.open(QIODevice::ReadWrite))		// Open file to take ownership
-	{
-		parent->GenMsg("open " + datfilename);
-		QuaZip zipFile(zipFileName);
-// Check if file already exist inside then remove it
-		if (fileAlreadyInsideZip(shortFileName, zipFileName))
-		{
-			parent->GenMsg("File " + shortFileName + " already inside zip");
-			if (copyZipWithoutFile(shortFileName, zipFileName))
-			{
-				parent->GenMsg("File " + shortFileName + " removed from zip");
-			}
-			else
-			{
-				parent->GenMsg("File " + shortFileName + " could not be removed from zip");
-				return false;
-			}
-		}
-// if zip file cannot open, create it
-    if (!zipFile.open(QuaZip::mdAdd)) zipFile.open(QuaZip::mdCreate);
-// open zip file
-		if (zipFile.getZipError() == UNZ_OK)
-		{
-			QuaZipFile outZipFile(&zipFile);
-// open dat file to add to zip file
-			if (datfile.isOpen())
-			{
-				bool zipped = true;
-				QByteArray data = datfile.readAll();
-				if (outZipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(shortFileName, shortFileName)))
-				{
-					outZipFile.write(data);
-					datfile.close();
-					if (outZipFile.getZipError() != UNZ_OK)
-					{
-						zipped = false;
-						parent->GenMsg("Cannot create Zip file " + zipFileName);
-						return false;
-					}
-					else parent->GenMsg("File : " + datfilename + " was zipped to " + zipFileName);
-					outZipFile.close();
-					if (zipped)
-					{
-						datfile.remove();
-						parent->GenMsg("File : " + datfilename + " was removed");
-					}
-				}
-				else
-				{
-					parent->GenMsg("Cannot open " + zipFileName);
-					return false;
-				}
-			}
-			else
-			{
-				parent->GenMsg("Cannot open " + datfilename);
-				return false;
-			}
-		}
-	}
-	else
-	{
-		parent->GenMsg("Cannot open " + datfilename);
-		return false;
-	}
-	return true;
-}
-
-
-
-
-
 void onewiredevice::convertDatToV2(QString)
 {
 }
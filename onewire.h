@@ -210,9 +210,6 @@ struct CommonRegStruct
 	void setHtmlMenulist(QListWidget *List);
 	void removeHtmlMenulist(QString name);
 	bool hasPreviousDatFile();
-	bool zipPreviousDatFile();
-	bool fileAlreadyInsideZip(QString datfileName, QString zipFileName);
-	bool copyZipWithoutFile(QString datfileName, QString zipFileName);
 	volatile CommonRegStruct *commonReg;
 	void setMasternullptr();
 	int meanTimeCalculation();
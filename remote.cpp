@@ -47,6 +47,7 @@
 remote::remote(logisdom *Parent) : net1wire(Parent)
 {
 	parent = Parent;
+	fifoViewTimer.stop();	// fifolist shows the trace log
 	TcpThread = new remotethread(Parent);
 	ui.localdevicecombolist->hide();
 	ui.gridLayout->removeWidget(ui.localdevicecombolist);
@@ -475,7 +476,7 @@ more:
 		while (index < fifoListCount())
 		{
 			bool found = false;
-			QString item = ui.fifolist->item(index)->text();
+			QString item = fifoListAt(index);
 			QString fifoorder = getOrder(item);
 			QString fifofilenamme = logisdom::getvalue(NetRequestMsg[GetDatFile], fifoorder);
 			//GenMsg("Try Remove extra : " + fifoorder + "   " + fifofilenamme);
@@ -521,9 +522,7 @@ more:
 			}
 			if (found)
 			{
-				QListWidgetItem *item = ui.fifolist->item(index);
-				ui.fifolist->takeItem(index);
-				delete item;
+				fifoListRemoveAt(index);
 				Buffer = "";
 			}
 			else index ++;
@@ -566,9 +565,9 @@ bool remote::isAdmin()
 void remote::addGetFiletoFifo(QString name, QString folder)
 {
 	if (folder.isEmpty()) //add2fifo(NetRequestMsg[GetFile] + " = (" + name + ")");
-		addtofifo(GetFile, NetRequestMsg[GetFile] + " = (" + name + ")");
+		addtofifo(GetFile, NetRequestMsg[GetFile] + " = (" + name + ")" + tcpData::rangeRequest(name));
 		else //add2fifo(NetRequestMsg[GetFile] + " = (" + name + ")" + NetRequestMsg[setFolder] + " = (" + folder + ")");
-		addtofifo(GetFile, NetRequestMsg[GetFile] + " = (" + name + ")" + NetRequestMsg[setFolder] + " = (" + folder + ")");
+		addtofifo(GetFile, NetRequestMsg[GetFile] + " = (" + name + ")" + NetRequestMsg[setFolder] + " = (" + folder + ")" + tcpData::rangeRequest(folder + QDir::separator() + name));
 }
 
 
@@ -577,7 +576,7 @@ void remote::addGetFiletoFifo(QString name, QString folder)
 void remote::addGetDatFiletoFifo(QString name)
 {
 //	add2fifo(NetRequestMsg[GetDatFile] + " = (" + name + ")");
-    addtofifo(GetDatFile, NetRequestMsg[GetDatFile] + " = (" + name + ")");
+    addtofifo(GetDatFile, NetRequestMsg[GetDatFile] + " = (" + name + ")" + tcpData::rangeRequest(parent->getrepertoiredat() + name + dat_ext));
 }
 
 
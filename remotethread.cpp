@@ -150,7 +150,71 @@ void remotethread::checkGetFile(tcpData &data)
 	QString filename;
 	if (folder.isEmpty()) filename = logisdom::getvalue(NetRequestMsg[GetFile], Header);
         else filename = folder + QDir::separator() + logisdom::getvalue(NetRequestMsg[GetFile], Header);
-    if (!filename.isEmpty())
+    // only the server writes the file size, the echoed request also holds RangeOffset
+    QString rangeSize = logisdom::getvalue(RangeSizeStr, Header);
+    if (!filename.isEmpty() && !rangeSize.isEmpty())
+    {
+        // range answer, write the part received after the local copy
+        qint64 start = logisdom::getvalue(RangeOffsetStr, Header).toLongLong();
+        qint64 fileSize = rangeSize.toLongLong();
+        QString checkSum = logisdom::getvalue(DataCheckSum, Header);
+        QString fileCheckSum = logisdom::getvalue(RangeFileSumStr, Header);
+        QString request = tcpData::removeRange(FIFOSpecial.first()->Request);
+        int Request_ID = FIFOSpecial.first()->Request_ID;
+        QFile file(filename);
+        bool failed = false;
+        if (!checkSum.isEmpty() && (QString(QCryptographicHash::hash(DataByte, QCryptographicHash::Md5).toHex()) != checkSum))
+        {
+            if (logEnabled) log += addTimeTag "checksum error on part of " + filename;
+            failed = true;
+        }
+        else if(file.open(QIODevice::ReadWrite))
+        {
+            file.resize(start);
+            file.seek(start);
+            file.write(DataByte);
+            if ((start + DataByte.size() < fileSize) && !DataByte.isEmpty())
+            {
+                file.close();
+                // ask for the next part, an interrupted transfer restarts from here
+                addToFIFOSpecial(Request_ID, request + tcpData::rangeRequest(filename));
+                if (logEnabled) log += addTimeTag QString("File %1 part %2/%3").arg(filename).arg(start + DataByte.size()).arg(fileSize);
+            }
+            else
+            {
+                // last part, the assembled file is checked once
+                if (!fileCheckSum.isEmpty() && (tcpData::fileCheckSum(file) != fileCheckSum))
+                {
+                    if (logEnabled) log += addTimeTag "checksum error on assembled file " + filename;
+                    file.close();
+                    file.remove();
+                    failed = true;
+                }
+                else
+                {
+                    file.close();
+                    rangeRetries.remove(filename);
+                }
+            }
+        }
+        else
+        {
+            if (logEnabled) log += addTimeTag "cannot open file " + filename;
+        }
+        if (failed)
+        {
+            // same range asked again, or the whole file when the assembled one was removed
+            if (rangeRetries[filename]++ < rangeRetryMax) addToFIFOSpecial(Request_ID, request + tcpData::rangeRequest(filename));
+            else
+            {
+                rangeRetries.remove(filename);
+                QFile::remove(filename);
+                if (logEnabled) log += addTimeTag "transfer abandoned after checksum errors, file removed " + filename;
+                emit(traceUpdate("Transfer abandoned after checksum errors : " + filename));
+            }
+        }
+    }
+    else if (!filename.isEmpty())
     {
         QFile file(filename);
         if(file.open(QIODevice::WriteOnly))
@@ -59,6 +59,7 @@ private:
 	QMutex mutexData;
 	bool Admin;
 	QList <FIFOStruc*> FIFOSpecial;
+	QHash <QString, int> rangeRetries;
 	void get(QTcpSocket &Socket, QString &Request, tcpData &data);
     void checkUserName(tcpData &data);
     void checkPassWord(tcpData &data);
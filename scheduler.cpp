@@ -0,0 +1,291 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#include "scheduler.h"
+
+
+
+scheduler::scheduler()
+{
+    wheel.resize(wheelLevels * wheelSlots);
+    minute = QDateTime::currentSecsSinceEpoch() / 60;
+    tick.setSingleShot(true);
+    connect(&tick, SIGNAL(timeout()), this, SLOT(advance()));
+    tick.start(int(60 - QDateTime::currentSecsSinceEpoch() % 60) * 1000);
+}
+
+
+
+
+scheduler &scheduler::instance()
+{
+    static scheduler wheelScheduler;
+    return wheelScheduler;
+}
+
+
+
+
+int scheduler::add(QObject *receiver)
+{
+    QMutexLocker locker(&mutex);
+    int id = ++lastId;
+    entries[id].receiver = receiver;
+    return id;
+}
+
+
+
+
+void scheduler::remove(int id)
+{
+    QMutexLocker locker(&mutex);
+    if (!entries.contains(id)) return;
+    unlink(id, entries[id]);
+    if (!entries[id].key.isEmpty()) dirty = true;
+    entries.remove(id);
+}
+
+
+
+
+void scheduler::setKey(int id, const QString &key)
+{
+    QMutexLocker locker(&mutex);
+    if (!entries.contains(id)) return;
+    entries[id].key = key;
+    dirty = true;
+}
+
+
+
+
+void scheduler::setEntry(int id, const QDateTime &next, qint64 period, int months, bool active)
+{
+    QMutexLocker locker(&mutex);
+    if (!entries.contains(id)) return;
+    entry &e = entries[id];
+    qint64 secs = next.toSecsSinceEpoch();
+    if ((e.next == secs) && (e.period == period) && (e.months == months) && (e.active == active)) return;
+    if (e.next != secs)
+    {
+        e.pending = false;
+        if (!e.key.isEmpty()) dirty = true;
+    }
+    e.next = secs;
+    e.period = period;
+    e.months = months;
+    e.active = active;
+    insert(id, e);
+}
+
+
+
+
+QDateTime scheduler::next(int id)
+{
+    QMutexLocker locker(&mutex);
+    if (!entries.contains(id)) return QDateTime();
+    return QDateTime::fromSecsSinceEpoch(entries[id].next);
+}
+
+
+
+
+// Elapsed deadline not taken yet, does not consume it
+bool scheduler::isPending(int id)
+{
+    QMutexLocker locker(&mutex);
+    if (!entries.contains(id)) return false;
+    const entry &e = entries[id];
+    if (!e.active) return false;
+    if (e.pending) return true;
+    return e.next <= QDateTime::currentSecsSinceEpoch();
+}
+
+
+
+
+// True once per elapsed deadline, the entry is already set to its next one
+bool scheduler::take(int id)
+{
+    QMutexLocker locker(&mutex);
+    if (!entries.contains(id)) return false;
+    entry &e = entries[id];
+    if (!e.active) return false;
+    if (e.pending)
+    {
+        e.pending = false;
+        return true;
+    }
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (e.next > now) return false;
+    e.next = following(e, now);
+    if (!e.key.isEmpty()) dirty = true;
+    insert(id, e);
+    notify(QList <int>() << id);
+    return true;
+}
+
+
+
+
+// Same line format as before : RomID#next ISO date, written only when a deadline moved
+void scheduler::save(const QString &fileName)
+{
+    QMutexLocker locker(&mutex);
+    if (!dirty) return;
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+    QTextStream out(&file);
+    QHash <int, entry>::const_iterator it;
+    for (it = entries.constBegin(); it != entries.constEnd(); ++it)
+        if (!it.value().key.isEmpty()) out << it.value().key + "#" + QDateTime::fromSecsSinceEpoch(it.value().next).toString(Qt::ISODate) + "\n";
+    file.close();
+    dirty = false;
+}
+
+
+
+
+void scheduler::insert(int id, entry &e)
+{
+    unlink(id, e);
+    if (!e.active) return;
+    qint64 due = qMax(e.next / 60, minute + 1);
+    qint64 delta = due - minute;
+    for (int level=0; level<wheelLevels; level++)
+    {
+        if (delta < (qint64(1) << (wheelBits * (level + 1))))
+        {
+            e.level = level;
+            e.slot = int(due >> (wheelBits * level)) & (wheelSlots - 1);
+            wheel[level * wheelSlots + e.slot].insert(id);
+            return;
+        }
+    }
+    e.level = wheelLevels;
+    overflow.insert(id);
+}
+
+
+
+
+void scheduler::unlink(int id, entry &e)
+{
+    if (e.level == wheelLevels) overflow.remove(id);
+    else if (e.level >= 0) wheel[e.level * wheelSlots + e.slot].remove(id);
+    e.level = -1;
+    e.slot = -1;
+}
+
+
+
+
+// Next deadline after now, seconds removed as the interval widget did
+qint64 scheduler::following(const entry &e, qint64 now)
+{
+    QDateTime next = QDateTime::fromSecsSinceEpoch(e.next);
+    if (e.months > 0)
+    {
+        QDateTime current = QDateTime::fromSecsSinceEpoch(now);
+        do next = next.addMonths(e.months);
+            while (next <= current);
+    }
+    else if (e.period > 0) next = next.addSecs(((now - e.next) / e.period + 1) * e.period);
+    int s = next.time().second();
+    if (s != 0) next = next.addSecs(-s);
+    return next.toSecsSinceEpoch();
+}
+
+
+
+
+void scheduler::expire(int id, entry &e, qint64 now, QList <int> &fired)
+{
+    if (e.active && (e.next <= now))
+    {
+        e.pending = true;
+        e.next = following(e, now);
+        if (!e.key.isEmpty()) dirty = true;
+        fired.append(id);
+    }
+    insert(id, e);
+}
+
+
+
+
+void scheduler::cascade(int level, qint64 now, QList <int> &fired)
+{
+    QSet <int> ids;
+    if (level == wheelLevels) ids.swap(overflow);
+    else ids.swap(wheel[level * wheelSlots + (int(minute >> (wheelBits * level)) & (wheelSlots - 1))]);
+    foreach (int id, ids)
+    {
+        entry &e = entries[id];
+        e.level = -1;
+        expire(id, e, now, fired);
+    }
+}
+
+
+
+
+void scheduler::notify(const QList <int> &fired)
+{
+    foreach (int id, fired)
+    {
+        const entry &e = entries[id];
+        if (e.receiver) QMetaObject::invokeMethod(e.receiver, "scheduled", Qt::QueuedConnection, Q_ARG(QDateTime, QDateTime::fromSecsSinceEpoch(e.next)));
+    }
+}
+
+
+
+
+// Called on each minute boundary, a long gap (sleep, clock change) rebuilds the wheel
+void scheduler::advance()
+{
+    QMutexLocker locker(&mutex);
+    QList <int> fired;
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    qint64 target = now / 60;
+    if ((target < minute) || (target - minute > wheelSlots))
+    {
+        minute = target;
+        QList <int> ids = entries.keys();
+        foreach (int id, ids) expire(id, entries[id], now, fired);
+    }
+    else while (minute < target)
+    {
+        minute++;
+        int level = 1;
+        while ((level <= wheelLevels) && ((minute & ((qint64(1) << (wheelBits * level)) - 1)) == 0)) cascade(level++, now, fired);
+        cascade(0, now, fired);
+    }
+    notify(fired);
+    tick.start(int(60 - now % 60) * 1000);
+}
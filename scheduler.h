@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+#include <QtCore>
+
+
+// Periodic deadlines of the save and calculate intervals in a hierarchical
+// timing wheel, level 0 slots are minutes, each level is 64 times longer
+
+class scheduler : public QObject
+{
+    Q_OBJECT
+#define wheelSlots 64
+#define wheelBits 6
+#define wheelLevels 4
+public:
+    static scheduler &instance();
+    int add(QObject *receiver);
+    void remove(int id);
+    void setKey(int id, const QString &key);
+    void setEntry(int id, const QDateTime &next, qint64 period, int months, bool active);
+    QDateTime next(int id);
+    bool take(int id);
+    bool isPending(int id);
+    void save(const QString &fileName);
+private:
+    scheduler();
+    struct entry
+    {
+        QObject *receiver = nullptr;
+        QString key;
+        qint64 next = 0;
+        qint64 period = 0;
+        int months = 0;
+        bool active = false;
+        bool pending = false;
+        int level = -1;
+        int slot = -1;
+    };
+    QMutex mutex;
+    QHash <int, entry> entries;
+    QVector <QSet <int> > wheel;
+    QSet <int> overflow;
+    QTimer tick;
+    qint64 minute = 0;
+    int lastId = 0;
+    bool dirty = true;
+    void insert(int id, entry &e);
+    void unlink(int id, entry &e);
+    qint64 following(const entry &e, qint64 now);
+    void expire(int id, entry &e, qint64 now, QList <int> &fired);
+    void cascade(int level, qint64 now, QList <int> &fired);
+    void notify(const QList <int> &fired);
+private slots:
+    void advance();
+};
+
+#endif // SCHEDULER_H
@@ -26,6 +26,7 @@
 #include <QUuid>
 #include <QTcpServer>
 #include <QDateTime>
+#include <QCryptographicHash>
 
 #include "globalvar.h"
 #include "connection.h"
@@ -43,6 +44,10 @@
 Server::Server(logisdom *Parent)
 {
 	clientconnected = 0;
+	responseCacheSize = 0;
+	responseCacheTick = 0;
+	expiryWheel.resize(expirySlots);
+	expiryTick = QDateTime::currentSecsSinceEpoch() / expirySlotSecs;
 	parent = Parent;
     connect(this, SIGNAL(newConnection()), this, SLOT(newSocket()));
 }
@@ -154,22 +159,42 @@ void Server::readconfigfile(QString &configdata)
 		ConnectionUsers.append(NewUser);
 	}
 	SearchLoopEnd
+	updateUserIndex();
 }
 
 
 
-int Server::GetNewId(int indexuser)
+void Server::updateUserIndex()
+{
+	QMutexLocker locker(&GetID);
+	userIndex.clear();
+	for (int n=0; n<ConnectionUsers.count(); n++) userIndex.insert(ConnectionUsers.at(n).Name, n);
+}
+
+
+
+int Server::findUser(const QString &Name)
+{
+	QMutexLocker locker(&GetID);
+	return userIndex.value(Name, -1);
+}
+
+
+
+QString Server::GetNewId(int indexuser)
 {
     QMutexLocker locker(&GetID);
-    QDateTime now = QDateTime::currentDateTime();
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    expireIDs(now);
     UserIDs newID;
     newID.WebID = IDGen.createUuid().toString();
     newID.WebID.remove("\{");
     newID.WebID.remove("}");
-    newID.timeout = now.addSecs(timeLimit);
+    newID.timeout = now + timeLimit;
     newID.Rigths = ConnectionUsers[indexuser].Rigths;
-    ConnectionIDs.append(newID);
-    return (ConnectionIDs.count() - 1);
+    ConnectionIDs.insert(newID.WebID, newID);
+    expiryWheel[(newID.timeout / expirySlotSecs) % expirySlots].append(newID.WebID);
+    return newID.WebID;
 }
 
 
@@ -177,12 +202,9 @@ int Server::GetNewId(int indexuser)
 
 void Server::setLastPageWeb(const QString &ID, const QString &pageweb)
 {
-	int count = ConnectionIDs.count();
-	for (int n=0; n<count; n++)
-		if (ConnectionIDs[n].WebID == ID)
-		{
-			ConnectionIDs[n].LastPageWeb = pageweb;
-		}
+	QMutexLocker locker(&GetID);
+	QHash<QString, UserIDs>::iterator it = ConnectionIDs.find(ID);
+	if (it != ConnectionIDs.end()) it->LastPageWeb = pageweb;
 }
 
 
@@ -190,44 +212,63 @@ void Server::setLastPageWeb(const QString &ID, const QString &pageweb)
 
 QString Server::getLastPageWeb(const QString &ID)
 {
-	int count = ConnectionIDs.count();
-	for (int n=0; n<count; n++)
-		if (ConnectionIDs[n].WebID == ID)
-		{
-			return ConnectionIDs[n].LastPageWeb;
-		}
+	QMutexLocker locker(&GetID);
+	QHash<QString, UserIDs>::const_iterator it = ConnectionIDs.constFind(ID);
+	if (it != ConnectionIDs.constEnd()) return it->LastPageWeb;
 	return "";
 }
 
 
-int Server::isIDValable(const QString &ID)
+
+
+void Server::setLastMenu(const QString &ID, const QString &menu)
 {
-        QMutexLocker locker(&GetID);
-        QDateTime now = QDateTime::currentDateTime();
-	int count;
-	bool found;
-	do
+	QMutexLocker locker(&GetID);
+	QHash<QString, UserIDs>::iterator it = ConnectionIDs.find(ID);
+	if (it != ConnectionIDs.end()) it->LastMenu = menu;
+}
+
+
+
+
+bool Server::isIDValable(const QString &ID, UserIDs &session)
+{
+	QMutexLocker locker(&GetID);
+	qint64 now = QDateTime::currentSecsSinceEpoch();
+	expireIDs(now);
+	QHash<QString, UserIDs>::iterator it = ConnectionIDs.find(ID);
+	if (it == ConnectionIDs.end()) return false;
+	if (it->timeout < now)
 	{
-		found = false;
-		count = ConnectionIDs.count();
-		for (int n=0; n<count; n++)
-		{
-			if (ConnectionIDs[n].timeout.secsTo(now) > 0)
-			{
-				ConnectionIDs.removeAt(n);
-				found = true;
-				break;
-			}
-		}
-	} while (found);
-	count = ConnectionIDs.count();
-	for (int n=0; n<count; n++)
-		if (ConnectionIDs[n].WebID == ID)
+		ConnectionIDs.erase(it);
+		return false;
+	}
+// the ID stays in its old slot, it is moved forward when that slot expires
+	it->timeout = now + timeLimit;
+	session = it.value();
+	return true;
+}
+
+
+
+
+void Server::expireIDs(qint64 now)
+{
+	qint64 tick = now / expirySlotSecs;
+	if (tick - expiryTick > expirySlots) expiryTick = tick - expirySlots;
+	while (expiryTick < tick)
+	{
+		expiryTick++;
+		QStringList slot;
+		slot.swap(expiryWheel[expiryTick % expirySlots]);
+		for (int n=0; n<slot.count(); n++)
 		{
-			ConnectionIDs[n].timeout = now.addSecs(timeLimit);
-			return n;
+			QHash<QString, UserIDs>::iterator it = ConnectionIDs.find(slot.at(n));
+			if (it == ConnectionIDs.end()) continue;
+			if (it->timeout < now) ConnectionIDs.erase(it);
+			else expiryWheel[qMax(it->timeout / expirySlotSecs, expiryTick + 1) % expirySlots].append(slot.at(n));
 		}
-	return -1;
+	}
 }
 
 
@@ -249,6 +290,44 @@ void Server::emitNewRequest(QString str)
 
 
 
+bool Server::getCachedResponse(const QString &key, cachedResponse &response)
+{
+	QMutexLocker locker(&responseCacheMutex);
+	QHash<QString, cachedResponse>::iterator it = responseCache.find(key);
+	if (it == responseCache.end()) return false;
+	it->lastUse = ++responseCacheTick;
+	response = it.value();
+	return true;
+}
+
+
+
+void Server::putCachedResponse(const QString &key, cachedResponse &response)
+{
+	response.etag = "\"" + QCryptographicHash::hash(response.body, QCryptographicHash::Md5).toHex() + "\"";
+	QMutexLocker locker(&responseCacheMutex);
+	if (responseCache.contains(key))
+	{
+		responseCacheSize -= responseCache.value(key).body.size();
+		responseCache.remove(key);
+	}
+	if (response.body.size() > responseCacheBudget / 4) return;
+// evict least recently used entries until the new one fits
+	while ((responseCacheSize + response.body.size() > responseCacheBudget) && !responseCache.isEmpty())
+	{
+		QHash<QString, cachedResponse>::iterator oldest = responseCache.begin();
+		for (QHash<QString, cachedResponse>::iterator it = responseCache.begin(); it != responseCache.end(); ++it)
+			if (it->lastUse < oldest->lastUse) oldest = it;
+		responseCacheSize -= oldest->body.size();
+		responseCache.erase(oldest);
+	}
+	response.lastUse = ++responseCacheTick;
+	responseCache.insert(key, response);
+	responseCacheSize += response.body.size();
+}
+
+
+
 int Server::clients()
 {
 	return SocketList.count();
@@ -52,28 +52,55 @@ struct UserIDs
 	QString WebID;
 	QString LastMenu;
 	QString LastPageWeb;
-	QDateTime timeout;
+	qint64 timeout;
 	int Rigths;
+};
+#define expirySlotSecs 60
+#define expirySlots (timeLimit / expirySlotSecs + 2)
+#define responseCacheBudget 8388608
+struct cachedResponse
+{
+	QByteArray contentType;
+	QByteArray body;
+	QByteArray etag;
+	QDateTime lastModified;
+	qint64 fileSize;
+	qint64 revision;
+	quint64 lastUse;
 };
 	QUuid IDGen;
 	Server(logisdom *Parent);
 	logisdom *parent;
 	int clients();
 	QList<UsersLogin> ConnectionUsers;
-	QList<UserIDs> ConnectionIDs;
 	void SaveConfigStr(QString &str);
 	void readconfigfile(QString &configdata);
-	int GetNewId(int indexuser);
-	int isIDValable(const QString &ID);
+	void updateUserIndex();
+	int findUser(const QString &Name);
+	QString GetNewId(int indexuser);
+	bool isIDValable(const QString &ID, UserIDs &session);
 	void setLastPageWeb(const QString &ID, const QString &pageweb);
 	QString getLastPageWeb(const QString &ID);
+	void setLastMenu(const QString &ID, const QString &menu);
 	void transfertToOthers(QString order, Connection *client = nullptr);
     QStringList banedIP;
+	bool getCachedResponse(const QString &key, cachedResponse &response);
+	void putCachedResponse(const QString &key, cachedResponse &response);
 private:
 	int clientconnected;
 	QList<Connection*> SocketList;
 	QString usersonnected;
     QMutex GetID;
+	QHash<QString, int> userIndex;
+	QHash<QString, UserIDs> ConnectionIDs;
+// expiry wheel, one slot per minute over the whole session lifetime
+	QVector<QStringList> expiryWheel;
+	qint64 expiryTick;
+	void expireIDs(qint64 now);
+	QMutex responseCacheMutex;
+	QHash<QString, cachedResponse> responseCache;
+	qint64 responseCacheSize;
+	quint64 responseCacheTick;
 public slots:
 	void sendAll();
     void clear();
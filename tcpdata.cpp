@@ -22,6 +22,7 @@
 
 
 
+#include <QCryptographicHash>
 #include "globalvar.h"
 #include "tcpdata.h"
 
@@ -138,3 +139,73 @@ void tcpData::getData(QByteArray &result)
 
 
 
+
+// Range fields appended to a file request, the remote side only sends
+// what follows the local copy when its first bytes have the same checksum
+QString tcpData::rangeRequest(const QString &fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly) || (file.size() == 0)) return QString(RangeOffsetStr " = (0)");
+	qint64 size = file.size();
+	QString prefix = tailCheckSum(file, size);
+	file.close();
+	return QString(RangeOffsetStr " = (%1)").arg(size) + RangePrefixStr " = (" + prefix + ")";
+}
+
+
+
+
+// MD5 of the whole file, only sent with the last part of a transfer
+QString tcpData::fileCheckSum(QFile &file)
+{
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	file.seek(0);
+	hash.addData(&file);
+	return QString(hash.result().toHex());
+}
+
+
+
+
+// MD5 of the last bytes before end, enough to know both copies share
+// the same beginning without reading the whole file on each request
+QString tcpData::tailCheckSum(QFile &file, qint64 end)
+{
+	qint64 begin = end - rangeTailSize;
+	if (begin < 0) begin = 0;
+	if (!file.seek(begin)) return "";
+	QByteArray tail = file.read(end - begin);
+	return QString(QCryptographicHash::hash(tail, QCryptographicHash::Md5).toHex());
+}
+
+
+
+
+QString tcpData::removeRange(const QString &request)
+{
+	int index = request.indexOf(RangeOffsetStr);
+	if (index == -1) return request;
+	return request.left(index);
+}
+
+
+
+
+QString tcpData::readRange(QFile &file, const QString &request, QByteArray &data)
+{
+	bool ok;
+	qint64 offset = logisdom::getvalue(RangeOffsetStr, request).toLongLong(&ok);
+	if (!ok) offset = 0;
+	QString prefix = logisdom::getvalue(RangePrefixStr, request);
+	qint64 size = file.size();
+	qint64 start = 0;
+	if ((offset > 0) && (offset <= size) && (tailCheckSum(file, offset) == prefix)) start = offset;
+	file.seek(start);
+	data = file.read(rangeChunkSize);
+	QString header;
+	header.append(logisdom::saveformat(RangeOffsetStr, QString("%1").arg(start)));
+	header.append(logisdom::saveformat(RangeSizeStr, QString("%1").arg(size)));
+	header.append(logisdom::saveformat(DataCheckSum, QString(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex())));
+	if (start + data.size() >= size) header.append(logisdom::saveformat(RangeFileSumStr, fileCheckSum(file)));
+	return header;
+}
@@ -46,6 +46,13 @@ class tcpData
 #define FileNameStr "FileName"
 #define FolderNameStr "FolderName"
 #define CompressedData "DataCompressed"
+#define RangeOffsetStr "RangeOffset"
+#define RangeSizeStr "RangeFileSize"
+#define RangePrefixStr "RangePrefixCheckSum"
+#define RangeFileSumStr "RangeFileSum"
+#define rangeRetryMax 3
+#define rangeChunkSize 1048576
+#define rangeTailSize 4096
 public:	
 	tcpData();
 	~tcpData();
@@ -58,6 +65,11 @@ public:
 	QByteArray Data;
 	QByteArray Header;
 	void getData(QByteArray &result);
+	static QString tailCheckSum(QFile &file, qint64 end);
+	static QString fileCheckSum(QFile &file);
+	static QString rangeRequest(const QString &fileName);
+	static QString removeRange(const QString &request);
+	static QString readRange(QFile &file, const QString &request, QByteArray &data);
 private slots:
 private:
 signals:
@@ -81,8 +81,16 @@ devteleinfo::devteleinfo(net1wire *Master, logisdom *Parent, QString RomID) : on
 
 bool devteleinfo::setscratchpad(const QString &devicescratchpad, bool enregistremode)
 {
-	scratchpad = devicescratchpad;
-	ScratchPad_Show.setText(scratchpad);
+    QHash <QString, QString> values, groups;
+    teleinfo::parseFrame(devicescratchpad, values, &groups);
+    return setFrameValues(values, groups, enregistremode);
+}
+
+
+
+
+bool devteleinfo::setFrameValues(const QHash <QString, QString> &values, const QHash <QString, QString> &groups, bool enregistremode)
+{
 	double val = logisdom::NA;
 	int parameter = ParameterList.currentIndex();
     if (parameter < 0)
@@ -94,85 +102,55 @@ bool devteleinfo::setscratchpad(const QString &devicescratchpad, bool enregistre
 		return false;
 	}
     QString Pstr = teleinfo::TeleInfoParamtoStr(parameter);
-    QString data = devicescratchpad;
-	// avoid OPTARIF BASE et BASE
-    if (parameter == teleinfo::BASE) data = data.remove("OPTARIF BASE");
-    int index = data.indexOf(Pstr);
-    QString txt;
-    if (index != -1)
+    if (values.contains(Pstr))
 	{
         bool ok;
-        int l = Pstr.length() + 1;
-        int chkLength = l + teleinfo::TeleInfoValeurLength(parameter) + (teleinfo::horodatage(parameter) * 14) + 2; // +2 to join SP and checksum
-        QString chk = data.mid(index, chkLength);
-        QByteArray byteArray = chk.toUtf8();
-        const char* cString = byteArray.constData();
-        unsigned char checksum_Mode1 = 0;
-        unsigned char checksum_Mode2 = 0;
-
-        for (int c=0; c<chkLength-1; c++)		// -2 don't count last SP and checksum
-        {
-            if (c<chkLength-2) checksum_Mode1 += *cString;
-            checksum_Mode2 += *cString;
-            txt += QString("[%1]").arg(*cString);
-            cString++;
-        }
-        checksum_Mode1 &= 0x3F;
-        checksum_Mode1 += 0x20;
-
-        checksum_Mode2 &= 0x3F;
-        checksum_Mode2 += 0x20;
-
-        VStr = data.mid(index + l + (teleinfo::horodatage(parameter) * 14), teleinfo::TeleInfoValeurLength(parameter));
+        VStr = values.value(Pstr);
+        scratchpad = groups.value(Pstr);
         val = VStr.toDouble(&ok);
-
-        if ((checksum_Mode1 == *cString) || (checksum_Mode2 == *cString) )
+        ScratchPad_Show.setText(VStr);
+        switch (parameter)
         {
-            ScratchPad_Show.setText(VStr);
-            switch (parameter)
-			{
-			case teleinfo::ADCO:
-				if (ok)
-				{
-					MainValue = val;
-					setLocalMainValue(MainValue, false);
-				}
-				else MainValue = logisdom::NA;
-				ADCOstr = VStr;
-				ui.MainText->setText(ADCOstr);
-				return true;
-			default :
-				if (ok)
-				{
-                    long int counter = long(val);
-					setResult(counter);
-					setLocalMainValue(MainValue, false);
-					ui.MainText->setText(QString("%1 pulses, Delta = %2").arg(counter).arg(Delta));
-					bool offsetUpdate = countInit.isitnow();
-                    bool record = false;
-                    if (enregistremode) record = true;
-                    if (counterMode.currentIndex() == RecRealTime) record = true;
-                    if (record)
-					{
-						if ((SaveOnUpdate.isChecked()) && (counterMode.currentIndex() == offsetMode))
-						{
-							if (offsetUpdate) savevalue(QDateTime::currentDateTime(), MainValue, ReadRecNow);
-						}
-						else savevalue(QDateTime::currentDateTime(), MainValue);
-					}
-                    if ((counterMode.currentIndex() == offsetMode) && (offsetUpdate)) Offset.setValue(int(counter));
-					ReadNow = false;
-					ReadRecNow = false;
-					return true;
-				}
-				else setLocalMainValue(translateMainValue(VStr), true);
-				validCount = 0;
-				ReadNow = false;
-				ReadRecNow = false;
-				return true;
-			}
-		}
-        //else ScratchPad_Show.setText(QString("Checksum failed checksum = %1 *cString = %2").arg(checksum).arg(*cString) + " " + txt);
+        case teleinfo::ADCO:
+            if (ok)
+            {
+                MainValue = val;
+                setLocalMainValue(MainValue, false);
+            }
+            else MainValue = logisdom::NA;
+            ADCOstr = VStr;
+            ui.MainText->setText(ADCOstr);
+            return true;
+        default :
+            if (ok)
+            {
+                long int counter = long(val);
+                setResult(counter);
+                setLocalMainValue(MainValue, false);
+                ui.MainText->setText(QString("%1 pulses, Delta = %2").arg(counter).arg(Delta));
+                bool offsetUpdate = countInit.isitnow();
+                bool record = false;
+                if (enregistremode) record = true;
+                if (counterMode.currentIndex() == RecRealTime) record = true;
+                if (record)
+                {
+                    if ((SaveOnUpdate.isChecked()) && (counterMode.currentIndex() == offsetMode))
+                    {
+                        if (offsetUpdate) savevalue(QDateTime::currentDateTime(), MainValue, ReadRecNow);
+                    }
+                    else savevalue(QDateTime::currentDateTime(), MainValue);
+                }
+                if ((counterMode.currentIndex() == offsetMode) && (offsetUpdate)) Offset.setValue(int(counter));
+                ReadNow = false;
+                ReadRecNow = false;
+                return true;
+            }
+            else setLocalMainValue(translateMainValue(VStr), true);
+            validCount = 0;
+            ReadNow = false;
+            ReadRecNow = false;
+            return true;
+        }
 	}
 	validCount ++;
 	if (validCount > 10)
@@ -41,6 +41,7 @@ public:
 	void setconfig(const QString &strsearch);
 	void GetConfigStr(QString &str);
 	bool setscratchpad(const QString &scratchpad, bool enregistremode = false);
+	bool setFrameValues(const QHash <QString, QString> &values, const QHash <QString, QString> &groups, bool enregistremode);
 	QComboBox counterMode;
 	QSpinBox Offset;
 	QDoubleSpinBox Coef;
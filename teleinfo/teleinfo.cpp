@@ -31,6 +31,7 @@
 #include "inputdialog.h"
 #include "messagebox.h"
 #include "teleinfo.h"
+#include "devteleinfo.h"
 
 
 
@@ -184,6 +185,54 @@ QString teleinfo::extractBuffer(const QString &data)
 
 
 
+// splits a frame in its groups : LF label SEP [date SEP] value SEP checksum CR
+// SEP is SP in historic mode and HT in standard mode, the checksum is
+// computed with or without the last separator depending on the meter
+// groups with a bad checksum are skipped, their count is returned
+// groups receives each valid group as read, checksum included
+int teleinfo::parseFrame(const QString &frame, QHash <QString, QString> &values, QHash <QString, QString> *groups)
+{
+    int errors = 0;
+    QByteArray bytes = frame.toLatin1();
+    int start = 0;
+    while (start < bytes.length())
+    {
+        int end = bytes.indexOf(CR, start);
+        if (end == -1) end = bytes.length();
+        int first = start;
+        while ((first < end) && (bytes.at(first) == LF)) first++;
+        int length = end - first;
+        start = end + 1;
+        if (length < 4) continue;
+        const char *group = bytes.constData() + first;
+        char sep = group[length - 2];
+        uchar checksum_Mode1 = 0;
+        for (int n=0; n<length-2; n++) checksum_Mode1 += uchar(group[n]);
+        uchar checksum_Mode2 = uchar(checksum_Mode1 + uchar(sep));
+        checksum_Mode1 = (checksum_Mode1 & 0x3F) + 0x20;
+        checksum_Mode2 = (checksum_Mode2 & 0x3F) + 0x20;
+        uchar checksum = uchar(group[length - 1]);
+        if ((checksum != checksum_Mode1) && (checksum != checksum_Mode2))
+        {
+            errors++;
+            continue;
+        }
+        QString body = QString::fromLatin1(group, length - 2);
+        int labelEnd = body.indexOf(QChar(sep));
+        if (labelEnd <= 0) continue;
+        QString label = body.left(labelEnd);
+        QString value = body.mid(labelEnd + 1);
+        if (value.indexOf(QChar(sep)) != -1) value = value.mid(value.indexOf(QChar(sep)) + 1);	// skip date
+        values.insert(label, value);
+        if (groups) groups->insert(label, QString::fromLatin1(group, length));
+    }
+    return errors;
+}
+
+
+
+
+
 void teleinfo::readbuffer()
 {
 	QByteArray data;
@@ -191,9 +240,12 @@ void teleinfo::readbuffer()
 	QMutexLocker locker(&mutexreadbuffer);
 //more:
     data = tcp.readAll();
-    QString logtxt;
-    for (int n=0; n<data.length(); n++) logtxt += QString(" %1").arg(uchar(data[n]));
-    GenMsg(tr("Read Raw : ") + logtxt);
+    if (ErrorLog->ui.checkBoxActivity->isChecked())
+    {
+        QString logtxt;
+        for (int n=0; n<data.length(); n++) logtxt += QString(" %1").arg(uchar(data[n]));
+        GenMsg(tr("Read Raw : ") + logtxt);
+    }
     extract = extractBuffer(data);
     /*if (extract.isEmpty())
     {
@@ -213,11 +265,16 @@ void teleinfo::readbuffer()
 	TimeOut.stop();
     //GenMsg(tr("Read : ") + extract);
     if (ui.checkBoxLog->isChecked()) ui.textBrowser->setPlainText(QDateTime::currentDateTime().toString("hh:mm:ss\n") + extract);
+    QHash <QString, QString> values, groups;
+    int errors = parseFrame(extract, values, &groups);
+    if (errors) GenMsg(QString("Checksum error on %1 groups").arg(errors));
     for (int n=0; n<localdevice.count(); n++)
     {
-        if (localdevice[n]->readNow())
-            if (!localdevice[n]->setscratchpad(extract, true))
-                GenError(34, localdevice[n]->getromid());
+        devteleinfo *dev = qobject_cast<devteleinfo*>(localdevice[n]);
+        if (!dev) continue;
+        if (dev->readNow())
+            if (!dev->setFrameValues(values, groups, true))
+                GenError(34, dev->getromid());
     }
     //if (tcp.bytesAvailable() > 0) goto more;
     TimeOut.start(DataTimeOut);
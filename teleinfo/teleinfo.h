@@ -62,6 +62,7 @@ enum TeleInfoValeur
 	static int TeleInfoValeurLength(int index);
 	static QString TeleInfoUnit(int index);
     static bool horodatage(int index);
+    static int parseFrame(const QString &frame, QHash <QString, QString> &values, QHash <QString, QString> *groups = nullptr);
     QTimer TimeOut;
 	int retry;
     bool receivedData = false;
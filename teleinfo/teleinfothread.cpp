@@ -70,6 +70,8 @@ void teleinfothread::run()
     //setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, (void *)&set, sizeof(int));
 //#endif
     isRunning = true;
+    link.setOwner(this, &log, &endLessLoop);
+    link.setSocket(&MySocket, &tcpStatus);
     QString msg = "Thread starts, first connection";
     TCPconnect(MySocket, msg);
     while (endLessLoop)
@@ -77,10 +79,7 @@ void teleinfothread::run()
         log.clear();
         sleep(1);
     }
-    MySocket.disconnectFromHost();
-    if (MySocket.state() != QAbstractSocket::UnconnectedState) MySocket.waitForDisconnected();
-    tcpStatus = MySocket.state();
-    emit(tcpStatusChange());
+    link.disconnectLink();
     isRunning = false;
 }
 
@@ -88,45 +87,9 @@ void teleinfothread::run()
 
 
 
-void teleinfothread::TCPconnect(QTcpSocket &Socket, QString &Status)
+void teleinfothread::TCPconnect(QTcpSocket &, QString &Status)
 {
-    log += addTimeTag "TCP Connect  " + Status;
-	int tryConnect = 1;
-	do
-	{
-        log += addTimeTag QString("TCP try connect %1").arg(tryConnect);
-		if (Socket.state() == QAbstractSocket::ConnectedState)
-		{
-			Socket.disconnectFromHost();
-            log += addTimeTag "Try Disconnect";
-            if (Socket.state() == QAbstractSocket::ConnectedState) Socket.waitForDisconnected();
-		}
-		if (Socket.state() == QAbstractSocket::UnconnectedState)
-		{
-            log += addTimeTag "Disconnect OK";
-		}
-		tcpStatus = Socket.state();
-		emit(tcpStatusChange());
-        if (endLessLoop)
-        {
-            Socket.connectToHost(moduleipaddress, port);
-            log += addTimeTag "Try Connect";
-            Socket.waitForConnected();
-            if (Socket.state() == QAbstractSocket::ConnectedState)
-            {
-                log += addTimeTag "Connect OK";
-            }
-            tcpStatus = Socket.state();
-            emit(tcpStatusChange());
-            tryConnect ++;
-        }
-        if (tryConnect > 10)
-        {
-            log.clear();
-            tryConnect = 0;
-        }
-    }
-    while ((Socket.state() != QAbstractSocket::ConnectedState) && (endLessLoop));
+    link.connectLink(moduleipaddress, port, Status);
 }
 
 
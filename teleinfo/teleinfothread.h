@@ -27,6 +27,7 @@
 #include <QtCore>
 #include <QThread>
 #include <QTcpSocket>
+#include "bustransport.h"
 
 
 class teleinfothread : public QThread
@@ -57,6 +58,7 @@ public:
 	bool endLessLoop;
 	QAbstractSocket::SocketState tcpStatus;
 private:
+    bustransport link;
 	void TCPconnect(QTcpSocket &Socket, QString &Status);
 signals:
     void tcpStatusUpdate(const QString&);
@@ -0,0 +1,211 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#include "updatepipeline.h"
+
+
+
+class updatetask : public QRunnable
+{
+public:
+    updatetask(updatepipeline *Pipeline, int Stage) { pipeline = Pipeline; stage = Stage; }
+    void run() { pipeline->work(stage); }
+private:
+    updatepipeline *pipeline;
+    int stage;
+};
+
+
+
+
+updatepipeline::updatepipeline()
+{
+    for (int n=0; n<lastStage; n++)
+    {
+        depends[n] = 0;
+        worker[n] = false;
+        duration[n] = 0;
+    }
+}
+
+
+
+
+void updatepipeline::setDependency(int stage, int before)
+{
+    depends[stage] |= (1u << before);
+}
+
+
+
+
+void updatepipeline::setWorker(int stage, bool state)
+{
+    worker[stage] = state;
+}
+
+
+
+
+void updatepipeline::start()
+{
+    if (running) return;
+    running = true;
+    started = 0;
+    done = 0;
+    clock.start();
+    dispatch();
+}
+
+
+
+
+bool updatepipeline::isRunning()
+{
+    return running;
+}
+
+
+
+
+qint64 updatepipeline::stageTime(int stage)
+{
+    QMutexLocker locker(&mutex);
+    if ((stage < 0) || (stage >= lastStage)) return 0;
+    return duration[stage];
+}
+
+
+
+
+qint64 updatepipeline::totalTime()
+{
+    QMutexLocker locker(&mutex);
+    return total;
+}
+
+
+
+
+QString updatepipeline::timings()
+{
+    QMutexLocker locker(&mutex);
+    QString str = QString("total %1 ms").arg(total);
+    for (int n=0; n<lastStage; n++) str += QString(", %1 %2 ms").arg(stageName(n)).arg(duration[n]);
+    return str;
+}
+
+
+
+
+QString updatepipeline::stageName(int stage)
+{
+    switch (stage)
+    {
+        case stageEvents : return "Events";
+        case stageConvert : return "Convert";
+        case stageRead : return "LectureRecAll";
+        case stageIcons : return "Icons";
+        case stageMeteo : return "Meteo";
+        case stageHeating : return "Heating";
+        case stageVirtual : return "VirtualDevices";
+        case stageSendAll : return "SendAll";
+        case stageGraph : return "Graph";
+        case stageTableau : return "Tableau";
+        case stageZip : return "ZipFile";
+        case stageNextSave : return "NextSave";
+    }
+    return "";
+}
+
+
+
+
+// Runs in a pool thread for worker stages
+void updatepipeline::work(int stage)
+{
+    QElapsedTimer timer;
+    timer.start();
+    emit(execute(stage));
+    QMetaObject::invokeMethod(this, "stageDone", Qt::QueuedConnection, Q_ARG(int, stage), Q_ARG(qint64, timer.elapsed()));
+}
+
+
+
+
+void updatepipeline::stageDone(int stage, qint64 ms)
+{
+    {
+        QMutexLocker locker(&mutex);
+        duration[stage] = ms;
+    }
+    done |= (1u << stage);
+    dispatch();
+}
+
+
+
+
+// A GUI stage may process events, the busy flag keeps dispatch from nesting
+void updatepipeline::dispatch()
+{
+    if (!running || busy) return;
+    int next = -1;
+    for (int n=0; n<lastStage; n++)
+    {
+        if (started & (1u << n)) continue;
+        if ((depends[n] & done) != depends[n]) continue;
+        if (worker[n])
+        {
+            started |= (1u << n);
+            QThreadPool::globalInstance()->start(new updatetask(this, n));
+        }
+        else if (next == -1) next = n;
+    }
+    if (next != -1)
+    {
+        started |= (1u << next);
+        busy = true;
+        QElapsedTimer timer;
+        timer.start();
+        emit(execute(next));
+        qint64 ms = timer.elapsed();
+        busy = false;
+        {
+            QMutexLocker locker(&mutex);
+            duration[next] = ms;
+        }
+        done |= (1u << next);
+        QTimer::singleShot(0, this, SLOT(dispatch()));
+        return;
+    }
+    if (done != ((1u << lastStage) - 1)) return;
+    {
+        QMutexLocker locker(&mutex);
+        total = clock.elapsed();
+    }
+    running = false;
+    emit(finished());
+}
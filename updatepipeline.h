@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+
+
+#ifndef UPDATEPIPELINE_H
+#define UPDATEPIPELINE_H
+#include <QtCore>
+
+
+// Minute update as a task graph : a stage starts once the stages it
+// depends on are done, worker stages run in the thread pool while the
+// others run one per event loop turn on the GUI thread
+
+class updatepipeline : public QObject
+{
+    Q_OBJECT
+public:
+    enum stage { stageEvents, stageConvert, stageRead, stageIcons, stageMeteo, stageHeating, stageVirtual, stageSendAll, stageGraph, stageTableau, stageZip, stageNextSave, lastStage };
+    updatepipeline();
+    void setDependency(int stage, int before);
+    void setWorker(int stage, bool state);
+    void start();
+    bool isRunning();
+    qint64 stageTime(int stage);
+    qint64 totalTime();
+    QString timings();
+    static QString stageName(int stage);
+    void work(int stage);
+private:
+    QMutex mutex;
+    quint32 depends[lastStage];
+    bool worker[lastStage];
+    qint64 duration[lastStage];
+    quint32 started = 0;
+    quint32 done = 0;
+    bool running = false;
+    bool busy = false;
+    qint64 total = 0;
+    QElapsedTimer clock;
+private slots:
+    void dispatch();
+    void stageDone(int stage, qint64 ms);
+signals:
+    void execute(int stage);
+    void finished();
+};
+
+#endif // UPDATEPIPELINE_H
@@ -0,0 +1,335 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+#include <QtCore>
+#include "quazip.h"
+#include "quazipfile.h"
+#include "globalvar.h"
+#include "zipcompactor.h"
+#include "logisdom.h"
+
+
+
+zipcompactor::zipcompactor()
+{
+}
+
+
+
+zipcompactor::~zipcompactor()
+{
+    stop();
+}
+
+
+
+
+void zipcompactor::setFolders(const QString &dat, const QString &zip)
+{
+    QMutexLocker locker(&mutex);
+    datFolder = dat;
+    zipFolder = zip;
+}
+
+
+
+
+// Can be called from any thread, the compactor starts when it has work
+void zipcompactor::append(const QString &romid)
+{
+    QMutexLocker locker(&mutex);
+    if (!queue.contains(romid)) queue.append(romid);
+    if (active) return;
+    active = true;
+    abort = false;
+    wait();
+    start(QThread::LowestPriority);
+}
+
+
+
+
+void zipcompactor::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        abort = true;
+        queue.clear();
+    }
+    wait();
+}
+
+
+
+
+void zipcompactor::run()
+{
+    if (!recovered)
+    {
+        QStringList journals = QDir(zipFolder).entryList(QStringList() << QString("*") + journalExtension, QDir::Files);
+        foreach (const QString &journal, journals)
+        {
+            QString zipFileName = zipFolder + journal;
+            zipFileName.chop(QString(journalExtension).length());
+            QMutexLocker locker(zipLock(zipFileName));
+            recover(zipFileName);
+        }
+        recovered = true;
+    }
+    forever
+    {
+        QString romid;
+        {
+            QMutexLocker locker(&mutex);
+            if (queue.isEmpty() || abort)
+            {
+                active = false;
+                return;
+            }
+            romid = queue.takeFirst();
+        }
+        compact(romid);
+    }
+}
+
+
+
+
+void zipcompactor::compact(const QString &romid)
+{
+    QDate today = QDate::currentDate();
+    QStringList fileList = QDir(datFolder).entryList(QStringList() << romid + "_*" + dat_ext, QDir::Files);
+    foreach (const QString &shortFileName, fileList)
+    {
+        if (abort) return;
+        QString YM = shortFileName.mid(romid.length() + 1);
+        YM.chop(QString(dat_ext).length());
+        if (YM.length() != 7) continue;
+        bool okY, okM;
+        int Y = YM.right(4).toInt(&okY);
+        int M = YM.left(2).toInt(&okM);
+        if (!okY || !okM) continue;
+        if ((Y == today.year()) && (M == today.month())) continue;
+        QString zipFileName = zipFolder + romid + "_" + QString("%1").arg(Y, 4, 10, QChar('0')) + ".zip";
+        archive(datFolder + shortFileName, shortFileName, zipFileName);
+    }
+}
+
+
+
+
+bool zipcompactor::archive(const QString &datFileName, const QString &shortFileName, const QString &zipFileName)
+{
+// the data loader reads the same archive, only readers of this zip wait
+    QMutexLocker locker(zipLock(zipFileName));
+    recover(zipFileName);
+    QFile datfile(datFileName);
+    if (!datfile.open(QIODevice::ReadOnly))
+    {
+        log("Cannot open " + datFileName);
+        return false;
+    }
+    quint32 crc = checksum(datfile);
+// left by an append interrupted after the archive was closed
+    if (alreadyInside(shortFileName, zipFileName, crc, datfile.size()))
+    {
+        datfile.close();
+        datfile.remove();
+        log("File " + shortFileName + " already inside " + zipFileName + ", " + datFileName + " was removed");
+        return true;
+    }
+    if (!writeJournal(zipFileName))
+    {
+        datfile.close();
+        QFile::remove(zipFileName + journalExtension);
+        log("Cannot write journal for " + zipFileName);
+        return false;
+    }
+    QuaZip zipFile(zipFileName);
+    bool ok;
+    if (QFile::exists(zipFileName)) ok = zipFile.open(QuaZip::mdAdd);
+    else ok = zipFile.open(QuaZip::mdCreate);
+    if (ok)
+    {
+        QuaZipFile outZipFile(&zipFile);
+        ok = outZipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(shortFileName, datFileName));
+        datfile.seek(0);
+        while (ok && !datfile.atEnd())
+        {
+            QByteArray chunk = datfile.read(compactorChunk);
+            if (outZipFile.write(chunk) != chunk.size()) ok = false;
+            if (abort) ok = false;
+        }
+        if (outZipFile.isOpen()) outZipFile.close();
+        if (outZipFile.getZipError() != UNZ_OK) ok = false;
+        zipFile.close();
+        if (zipFile.getZipError() != UNZ_OK) ok = false;
+    }
+    datfile.close();
+    if (!ok)
+    {
+        recover(zipFileName);
+        log("Cannot add " + datFileName + " to zip file " + zipFileName);
+        return false;
+    }
+    QFile::remove(zipFileName + journalExtension);
+    datfile.remove();
+    log("File : " + datFileName + " was zipped to " + zipFileName + " and removed");
+    return true;
+}
+
+
+
+
+// Only the central directory is read, entries are not decompressed
+bool zipcompactor::alreadyInside(const QString &shortFileName, const QString &zipFileName, quint32 crc, qint64 size)
+{
+    if (!QFile::exists(zipFileName)) return false;
+    QuaZip zipFile(zipFileName);
+    if (!zipFile.open(QuaZip::mdUnzip)) return false;
+    bool found = false;
+    QuaZipFileInfo info;
+// the data loader uses the last entry of a name
+    for(bool more=zipFile.goToFirstFile(); more; more=zipFile.goToNextFile())
+    {
+        if (zipFile.getCurrentFileInfo(&info))
+            if (info.name == shortFileName) found = (info.crc == crc) && (qint64(info.uncompressedSize) == size);
+    }
+    zipFile.close();
+    return found;
+}
+
+
+
+
+// The append only writes from the central directory offset, saving
+// the old central directory is enough to restore the archive
+bool zipcompactor::writeJournal(const QString &zipFileName)
+{
+    QFile journal(zipFileName + journalExtension);
+    if (!journal.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&journal);
+    QFile zipFile(zipFileName);
+    if (!zipFile.exists()) out << qint64(-1);
+    else
+    {
+        if (!zipFile.open(QIODevice::ReadOnly)) return false;
+        qint64 offset = centralDirectory(zipFile);
+        if (offset < 0) return false;
+        zipFile.seek(offset);
+        out << offset << zipFile.readAll();
+        zipFile.close();
+    }
+    journal.close();
+    return (out.status() == QDataStream::Ok) && (journal.error() == QFile::NoError);
+}
+
+
+
+
+void zipcompactor::recover(const QString &zipFileName)
+{
+    QFile journal(zipFileName + journalExtension);
+    if (!journal.exists()) return;
+    if (journal.open(QIODevice::ReadOnly))
+    {
+        QDataStream in(&journal);
+        qint64 offset = 0;
+        QByteArray tail;
+        in >> offset;
+        if (in.status() != QDataStream::Ok) offset = 0;
+        else if (offset < 0) QFile::remove(zipFileName);
+        else
+        {
+            in >> tail;
+            QFile zipFile(zipFileName);
+            if ((in.status() == QDataStream::Ok) && zipFile.open(QIODevice::ReadWrite))
+            {
+                zipFile.resize(offset);
+                zipFile.seek(offset);
+                zipFile.write(tail);
+                zipFile.close();
+                log("Zip file " + zipFileName + " restored after an interrupted append");
+            }
+        }
+        journal.close();
+    }
+    journal.remove();
+}
+
+
+
+
+// One lock per archive, shared with the data loader zip reads
+QMutex *zipcompactor::zipLock(const QString &zipFileName)
+{
+    static QMutex registryMutex;
+    static QHash <QString, QMutex*> registry;
+    QMutexLocker locker(&registryMutex);
+    QMutex *lock = registry.value(zipFileName);
+    if (!lock)
+    {
+        lock = new QMutex;
+        registry.insert(zipFileName, lock);
+    }
+    return lock;
+}
+
+
+
+
+qint64 zipcompactor::centralDirectory(QFile &zipFile)
+{
+// end of central directory record is in the last 64 KB + 22 bytes
+    qint64 size = zipFile.size();
+    qint64 from = qMax(qint64(0), size - 65557);
+    zipFile.seek(from);
+    QByteArray data = zipFile.read(size - from);
+    int pos = data.lastIndexOf(QByteArray("PK\x05\x06", 4));
+    if ((pos < 0) || (pos + 22 > data.size())) return -1;
+    return qint64(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData()) + pos + 16));
+}
+
+
+
+
+quint32 zipcompactor::checksum(QFile &file)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+    file.seek(0);
+    while (!file.atEnd())
+    {
+        QByteArray chunk = file.read(compactorChunk);
+        if (chunk.isEmpty()) break;
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(chunk.constData()), uInt(chunk.size()));
+    }
+    return quint32(crc);
+}
+
+
+
+
+void zipcompactor::log(const QString &msg)
+{
+    if (parent) parent->GenMsg(msg);
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 Remy CARISIO.
+**
+** This file is part of the LogisDom project from Remy CARISIO.
+** remy.carisio@orange.fr   http://logisdom.fr
+** LogisDom is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+
+** LogisDom is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+
+** You should have received a copy of the GNU General Public License
+** along with LogisDom.  If not, see <https://www.gnu.org/licenses/>
+**
+****************************************************************************/
+
+
+
+#ifndef ZIPCOMPACTOR_H
+#define ZIPCOMPACTOR_H
+
+#include <QThread>
+#include <QMutex>
+#include <QStringList>
+
+class logisdom;
+
+
+// Moves the dat files of past months into the yearly zip archives.
+// Each file is streamed as a new entry appended to the archive, the
+// central directory replaced by the append is kept in a journal so an
+// interrupted append is rolled back on the next run.
+
+class zipcompactor : public QThread
+{
+    Q_OBJECT
+#define compactorChunk 65536
+#define journalExtension ".journal"
+public:
+    zipcompactor();
+    ~zipcompactor();
+    void run();
+    void append(const QString &romid);
+    void setFolders(const QString &dat, const QString &zip);
+    void stop();
+    static QMutex *zipLock(const QString &zipFileName);
+    logisdom *parent = nullptr;
+private:
+    QMutex mutex;
+    QStringList queue;
+    QString datFolder;
+    QString zipFolder;
+    bool active = false;
+    bool recovered = false;
+    bool abort = false;
+    void compact(const QString &romid);
+    bool archive(const QString &datFileName, const QString &shortFileName, const QString &zipFileName);
+    bool alreadyInside(const QString &shortFileName, const QString &zipFileName, quint32 crc, qint64 size);
+    bool writeJournal(const QString &zipFileName);
+    void recover(const QString &zipFileName);
+    static qint64 centralDirectory(QFile &zipFile);
+    static quint32 checksum(QFile &file);
+    void log(const QString &msg);
+};
+
+#endif // ZIPCOMPACTOR_H